@@ -26,17 +26,17 @@
 // uncomment to disable colors
 // #define NCOLORS
 
-#define ESC "\x1b"
+#define CLR_ESC "\x1b"
 
-#define CLR_BRED ESC "[1;31m"
-#define CLR_BGRN ESC "[1;32m"
-#define CLR_BYEL ESC "[1;33m"
-#define CLR_BBLU ESC "[1;34m"
-#define CLR_BMAG ESC "[1;35m"
-#define CLR_BCYN ESC "[1;36m"
+#define CLR_BRED CLR_ESC "[1;31m"
+#define CLR_BGRN CLR_ESC "[1;32m"
+#define CLR_BYEL CLR_ESC "[1;33m"
+#define CLR_BBLU CLR_ESC "[1;34m"
+#define CLR_BMAG CLR_ESC "[1;35m"
+#define CLR_BCYN CLR_ESC "[1;36m"
 
 #ifndef NCOLORS
-#define CLR_RESET ESC "[39;49m"
+#define CLR_RESET CLR_ESC "[39;49m"
 
 // error messages color
 #define CLR_ERR_MSG CLR_BRED
@@ -61,6 +61,17 @@
 #define CLR_INTERNAL
 #endif
 
+//=:config:stats
+// uncomment to compile out statistics collection (--stats)
+// #define NSTATS
+
+//=:config:profile
+// uncomment to compile out execution profiler (--profile)
+// #define NPROFILE
+
+// max number of frames of a folded stack written by profiler
+#define PROFILE_MAX_DEPTH (64)
+
 //=:config:output_format
 // source tree indentation
 #define SOURCE_INDENTATION (0)
@@ -88,6 +99,64 @@
 
 #define REPL_RESULT_SUFFIX "\n"
 
+//=:config:server
+// number of evaluation contexts created before server accepts connections
+#define SERVER_POOL_SIZE (8)
+
+// max length of a request line, longer lines are answered by an error
+#define SERVER_LINE_MAX (4096)
+
+// replies pending for a connection after which its requests are not read
+#define SERVER_OUTPUT_MAX (1 << 16)
+
+#define SERVER_BACKLOG (128)
+
+#define SERVER_MAX_EVENTS (64)
+
+//=:config:reductions
+// uncomment to compile out threads of reductions, they are evaluated serially
+// #define NTHREADS
+
+// least number of terms reduced by a chunk, ranges are split into at most
+// REDUCE_CHUNKS_MAX chunks of equal length
+#define REDUCE_CHUNK_MIN (1024)
+
+#define REDUCE_CHUNKS_MAX (65536)
+
+// least number of terms of a reduction split across threads
+#define REDUCE_PARALLEL_MIN (16384)
+
+#define REDUCE_THREADS_MAX (64)
+
+// least estimated cost of a subtree evaluated by a thread of its own, in
+// costs of an arithmetic operator, which take 30ns or so
+#define TASK_COST_MIN (1 << 12)
+
+// max number of evaluations of body of solve after its bounds
+#define SOLVE_ITERATIONS_MAX (200)
+
+// max number of intervals of adaptive quadrature of integrate
+#define INTEGRATE_INTERVALS_MAX (256)
+
+// integration stops when estimated error is below one of tolerances
+#define INTEGRATE_ABS_TOL (1e-300)
+
+#define INTEGRATE_REL_TOL (1e-13)
+
+//=:config:grid
+// max number of points of a grid axis
+#define GRID_AXIS_MAX (1 << 24)
+
+// points of grid evaluated before they are written
+#define GRID_BAND_POINTS (1 << 16)
+
+// points of grid evaluated by a thread at once, results of a tile fit L1
+#define GRID_TILE_ROWS (16)
+
+#define GRID_TILE_COLS (32)
+
+#define GRID_THREADS_MAX (64)
+
 //=:config:math
 #define MAX_DIFF_ULPS (4096)
 
@@ -95,11 +164,67 @@
 
 #define MAX_DIFF_ABS (0.00000000001)
 
+//=:config:interner
+// max number of characters of an identifier
+#define SYMBOL_NAME_MAX (256)
+
+// max number of identifiers of a handle, must be multiple of
+// INTERN_BLOCK_SYMBOLS
+#define INTERN_SYMBOLS_MAX (1 << 22)
+
+#define INTERN_BLOCK_SYMBOLS (1024)
+
+// must be 2^n
+#define INTERN_INDEX_CAPACITY (256)
+
+// size of blocks of names of identifiers
+#define INTERN_ARENA_BLOCK (1 << 16)
+
 //=:config:internal
 // must be at least 1
 #define INTERNAL_READING_BUF_SIZE (512)
 
 #define NODE_BUF_SIZE (1 << 20)
 
+// max depth of stack of values kept on the C stack by evaluation, deeper
+// programs use a heap one
+#define STACK_LOCAL_MAX (64)
+
+// max number of nodes of a program copied out of parser buffer, buffer of
+// larger programs is passed to them
+#define PROGRAM_COPY_MAX_NODES (4096)
+
+// least number of nodes of a repeated subtree evaluated once per program
+#define SHARE_NODES_MIN (3)
+
+// largest integer exponent of a literal, by which powers are multiplied
+#define SIMPLIFY_POW_MAX (64)
+
+// least degree of polynomials evaluated by Estrin's scheme instead of Horner's
+#define POLY_ESTRIN_MIN (32)
+
+// least number of alternatives of a conditional testing one variable against
+// sorted literals, which are chosen by binary search, must be at least 2
+#define RANGE_ALTERNATIVES_MIN (4)
+
+// max depth of calls of user functions, stack of program is reserved for
+// bodies of all of them
+#define FUNCTION_DEPTH_MAX (1024)
+
+// number of entries of cache of values of pure functions, must be 2^n
+#define FUNCTION_MEMO_CAPACITY (1 << 12)
+
+// max number of arguments of pure functions, values of which are cached
+#define FUNCTION_MEMO_ARGS_MAX (2)
+
+// size of buffer of results written to stdout
+#define OUTPUT_BUF_SIZE (1 << 16)
+
+// initial capacity of parser frames, grows on demand
+#define PARSER_FRAMES_CAPACITY (64)
+
 // must be not 2^n
 #define GLOBAL_SCOPE_CAPACITY (255)
+
+// must be not 2^n
+#define PROFILE_BUILTINS_CAPACITY (61)
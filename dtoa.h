@@ -0,0 +1,384 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef DTOA_H
+#define DTOA_H
+
+// Shortest round-trip conversion of doubles to decimal, after Ulf Adams,
+// "Ryu: fast float-to-string conversion" (PLDI 2018). The digits written are
+// the fewest that read back as the same double, nearest to the exact value.
+
+#include "dtoa_table.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// enough for "-0.000001" followed by 17 digits, and for "-d.<16>e-324";
+#define DT_BUF_SIZE (32)
+
+#define DT_MANTISSA_BITS (52)
+#define DT_EXPONENT_BITS (11)
+#define DT_BIAS (1023)
+
+//=:dtoa:arithmetic
+
+// pow5bits - returns bit length of 5^e, for e in [0, 3528];
+static inline int32_t dt_pow5bits(int32_t e) {
+  return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// log10_pow2 - returns floor(log10(2^e)), for e in [0, 1650];
+static inline uint32_t dt_log10_pow2(int32_t e) {
+  return ((uint32_t)e * 78913) >> 18;
+}
+
+// log10_pow5 - returns floor(log10(5^e)), for e in [0, 2620];
+static inline uint32_t dt_log10_pow5(int32_t e) {
+  return ((uint32_t)e * 732923) >> 20;
+}
+
+static inline uint32_t dt_pow5_factor(uint64_t v) {
+  uint32_t count = 0;
+
+  for (; v % 5 == 0; v /= 5)
+    ++count;
+
+  return count;
+}
+
+static inline bool dt_multiple_of_pow5(uint64_t v, uint32_t p) {
+  return dt_pow5_factor(v) >= p;
+}
+
+static inline bool dt_multiple_of_pow2(uint64_t v, uint32_t p) {
+  return (v & ((1ull << p) - 1)) == 0;
+}
+
+#if defined(__SIZEOF_INT128__) && !defined(DT_NO_INT128)
+__extension__ typedef unsigned __int128 dt_uint128;
+
+// mul_shift - returns (m * mul) >> j, where mul is 128-bit and j >= 64;
+static inline uint64_t dt_mul_shift(uint64_t m, const uint64_t mul[static 2],
+                                    int32_t j) {
+  dt_uint128 b0 = (dt_uint128)m * mul[0];
+  dt_uint128 b2 = (dt_uint128)m * mul[1];
+  return (uint64_t)(((b0 >> 64) + b2) >> (j - 64));
+}
+#else
+static inline uint64_t dt_umul128(uint64_t a, uint64_t b, uint64_t hi[static 1]) {
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+
+  uint64_t lo_lo = a_lo * b_lo;
+  uint64_t hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi;
+  uint64_t hi_hi = a_hi * b_hi;
+
+  uint64_t mid = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+  *hi = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (mid >> 32);
+  return (mid << 32) | (uint32_t)lo_lo;
+}
+
+// mul_shift - returns (m * mul) >> j, where mul is 128-bit and 64 < j < 128;
+static inline uint64_t dt_mul_shift(uint64_t m, const uint64_t mul[static 2],
+                                    int32_t j) {
+  uint64_t high0, high1;
+  dt_umul128(m, mul[0], &high0);
+  uint64_t low1 = dt_umul128(m, mul[1], &high1);
+
+  uint64_t sum = high0 + low1;
+  if (sum < high0)
+    ++high1;
+
+  uint32_t dist = (uint32_t)(j - 64);
+  return (high1 << (64 - dist)) | (sum >> dist);
+}
+#endif
+
+static inline uint32_t dt_decimal_length(uint64_t v) {
+  uint32_t len = 1;
+
+  for (uint64_t p = 10; len < 20 && v >= p; p *= 10)
+    ++len;
+
+  return len;
+}
+
+//=:dtoa:conversion
+
+// Dt_Decimal - value equal to digits * 10^exponent;
+typedef struct {
+  uint64_t digits;
+  int32_t exponent;
+} Dt_Decimal;
+
+// dt_d2d - converts finite non-zero double, given by its raw fields, to the
+// shortest decimal of the rounding interval;
+static inline Dt_Decimal dt_d2d(uint64_t ieee_mantissa, uint32_t ieee_exponent) {
+  int32_t e2;
+  uint64_t m2;
+
+  if (ieee_exponent == 0) {
+    e2 = 1 - DT_BIAS - DT_MANTISSA_BITS - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = (int32_t)ieee_exponent - DT_BIAS - DT_MANTISSA_BITS - 2;
+    m2 = (1ull << DT_MANTISSA_BITS) | ieee_mantissa;
+  }
+
+  // bounds of the interval are included when mantissa is even, since
+  // reading rounds halfway cases to even;
+  const bool accept_bounds = (m2 & 1) == 0;
+
+  // the interval is [mv - mm_shift - 1, mv + 2] in units of 2^e2;
+  const uint64_t mv = 4 * m2;
+  const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+  uint64_t vr, vp, vm;
+  int32_t e10;
+  bool vm_trailing_zeros = false;
+  bool vr_trailing_zeros = false;
+
+  if (e2 >= 0) {
+    const uint32_t q = dt_log10_pow2(e2) - (e2 > 3);
+    const int32_t k = DT_POW5_INV_BITCOUNT + dt_pow5bits((int32_t)q) - 1;
+    const int32_t i = -e2 + (int32_t)q + k;
+    e10 = (int32_t)q;
+
+    vr = dt_mul_shift(4 * m2, DT_POW5_INV_SPLIT[q], i);
+    vp = dt_mul_shift(4 * m2 + 2, DT_POW5_INV_SPLIT[q], i);
+    vm = dt_mul_shift(4 * m2 - 1 - mm_shift, DT_POW5_INV_SPLIT[q], i);
+
+    if (q <= 21) {
+      // only one of mp, mv and mm can be a multiple of 5, if any;
+      if (mv % 5 == 0)
+        vr_trailing_zeros = dt_multiple_of_pow5(mv, q);
+      else if (accept_bounds)
+        vm_trailing_zeros = dt_multiple_of_pow5(mv - 1 - mm_shift, q);
+      else
+        vp -= dt_multiple_of_pow5(mv + 2, q);
+    }
+  } else {
+    const uint32_t q = dt_log10_pow5(-e2) - (-e2 > 1);
+    const int32_t i = -e2 - (int32_t)q;
+    const int32_t k = dt_pow5bits(i) - DT_POW5_BITCOUNT;
+    const int32_t j = (int32_t)q - k;
+    e10 = (int32_t)q + e2;
+
+    vr = dt_mul_shift(4 * m2, DT_POW5_SPLIT[i], j);
+    vp = dt_mul_shift(4 * m2 + 2, DT_POW5_SPLIT[i], j);
+    vm = dt_mul_shift(4 * m2 - 1 - mm_shift, DT_POW5_SPLIT[i], j);
+
+    if (q <= 1) {
+      // mv has at least q trailing zero bits, so vr has trailing zeros;
+      vr_trailing_zeros = true;
+      if (accept_bounds)
+        vm_trailing_zeros = mm_shift == 1;
+      else
+        --vp;
+    } else if (q < 63) {
+      vr_trailing_zeros = dt_multiple_of_pow2(mv, q);
+    }
+  }
+
+  // remove digits while the interval still contains a shorter decimal;
+  int32_t removed = 0;
+  uint8_t last_removed = 0;
+  uint64_t output;
+
+  if (vm_trailing_zeros || vr_trailing_zeros) {
+    for (; vp / 10 > vm / 10; ++removed) {
+      vm_trailing_zeros &= vm % 10 == 0;
+      vr_trailing_zeros &= last_removed == 0;
+      last_removed = (uint8_t)(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+    }
+
+    if (vm_trailing_zeros) {
+      for (; vm % 10 == 0; ++removed) {
+        vr_trailing_zeros &= last_removed == 0;
+        last_removed = (uint8_t)(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+      }
+    }
+
+    // exact halfway value is rounded to even;
+    if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0)
+      last_removed = 4;
+
+    output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                   last_removed >= 5);
+  } else {
+    bool round_up = false;
+
+    if (vp / 100 > vm / 100) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+
+    for (; vp / 10 > vm / 10; ++removed) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+    }
+
+    output = vr + (vr == vm || round_up);
+  }
+
+  return (Dt_Decimal){output, e10 + removed};
+}
+
+//=:dtoa:output
+
+// dt_special - writes zero, infinity or NaN and returns length, or 0 if v is
+// a finite non-zero number;
+static inline size_t dt_special(char dst[static DT_BUF_SIZE], double v,
+                                uint64_t bits[static 1]) {
+  memcpy(bits, &v, sizeof v);
+
+  const bool sign = *bits >> 63;
+  const uint64_t mantissa = *bits & ((1ull << DT_MANTISSA_BITS) - 1);
+  const uint32_t exponent =
+      (uint32_t)(*bits >> DT_MANTISSA_BITS) & ((1u << DT_EXPONENT_BITS) - 1);
+
+  const char *s;
+  if (exponent == (1u << DT_EXPONENT_BITS) - 1)
+    s = mantissa != 0 ? "nan" : "inf";
+  else if (exponent == 0 && mantissa == 0)
+    s = "0";
+  else
+    return 0;
+
+  size_t len = 0;
+  if (sign)
+    dst[len++] = '-';
+  memcpy(&dst[len], s, strlen(s));
+  return len + strlen(s);
+}
+
+static inline Dt_Decimal dt_decimal(uint64_t bits) {
+  return dt_d2d(bits & ((1ull << DT_MANTISSA_BITS) - 1),
+                (uint32_t)(bits >> DT_MANTISSA_BITS) &
+                    ((1u << DT_EXPONENT_BITS) - 1));
+}
+
+// dt_digits - writes len digits of v, most significant first;
+static inline void dt_digits(char *dst, uint64_t v, uint32_t len) {
+  for (uint32_t i = len; i > 0; --i) {
+    dst[i - 1] = (char)('0' + v % 10);
+    v /= 10;
+  }
+}
+
+// dt_significand - writes digits with decimal point after the first one, or
+// without it for a single digit, returns length;
+static inline size_t dt_significand(char *dst, uint64_t v, uint32_t len) {
+  dt_digits(&dst[1], v, len);
+  dst[0] = dst[1];
+  if (len == 1)
+    return 1;
+
+  dst[1] = '.';
+  return len + 1;
+}
+
+// dt_format - writes v in positional notation when 1e-6 <= |v| < 1e21, and
+// in exponential notation otherwise, returns length. Output is not
+// terminated;
+static inline size_t dt_format(char dst[static DT_BUF_SIZE], double v) {
+  uint64_t bits;
+  size_t len = dt_special(dst, v, &bits);
+  if (len != 0)
+    return len;
+
+  if (bits >> 63)
+    dst[len++] = '-';
+
+  Dt_Decimal d = dt_decimal(bits);
+  uint32_t olength = dt_decimal_length(d.digits);
+
+  // position of decimal point relative to the first digit;
+  int32_t point = (int32_t)olength + d.exponent;
+
+  if (point > 21 || point < -5) {
+    len += dt_significand(&dst[len], d.digits, olength);
+
+    int32_t exp = point - 1;
+    dst[len++] = 'e';
+    dst[len++] = exp < 0 ? '-' : '+';
+    exp = exp < 0 ? -exp : exp;
+
+    uint32_t exp_len = exp >= 100 ? 3 : exp >= 10 ? 2 : 1;
+    dt_digits(&dst[len], (uint64_t)exp, exp_len);
+    return len + exp_len;
+  }
+
+  if (point <= 0) {
+    dst[len++] = '0';
+    dst[len++] = '.';
+    memset(&dst[len], '0', (size_t)-point);
+    len += (size_t)-point;
+    dt_digits(&dst[len], d.digits, olength);
+    return len + olength;
+  }
+
+  if ((uint32_t)point < olength) {
+    dt_digits(&dst[len], d.digits, olength);
+    memmove(&dst[len + point + 1], &dst[len + point], olength - point);
+    dst[len + point] = '.';
+    return len + olength + 1;
+  }
+
+  dt_digits(&dst[len], d.digits, olength);
+  memset(&dst[len + olength], '0', (size_t)point - olength);
+  return len + (size_t)point;
+}
+
+// dt_format_sci - writes significand of v in [1, 10) and stores its decimal
+// exponent, so v is written as significand*10^exponent, returns length;
+static inline size_t dt_format_sci(char dst[static DT_BUF_SIZE], double v,
+                            int32_t exponent[static 1]) {
+  uint64_t bits;
+  size_t len = dt_special(dst, v, &bits);
+
+  *exponent = 0;
+  if (len != 0)
+    return len;
+
+  if (bits >> 63)
+    dst[len++] = '-';
+
+  Dt_Decimal d = dt_decimal(bits);
+  uint32_t olength = dt_decimal_length(d.digits);
+
+  *exponent = d.exponent + (int32_t)olength - 1;
+  return len + dt_significand(&dst[len], d.digits, olength);
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dtoa.h"
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t rng_next(void) {
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+static void expect(double v, const char *want) {
+  char dst[DT_BUF_SIZE + 1];
+  dst[dt_format(dst, v)] = '\0';
+
+  if (strcmp(dst, want) != 0) {
+    fprintf(stderr, "dt_format(%a) = \"%s\", want \"%s\"\n", v, dst, want);
+    abort();
+  }
+}
+
+// shortest - returns number of significant digits of the shortest decimal
+// that reads back as v, found by printf;
+static int shortest(double v) {
+  char buf[64];
+
+  for (int p = 1; p < 17; ++p) {
+    snprintf(buf, sizeof buf, "%.*e", p - 1, v);
+    if (strtod(buf, NULL) == v)
+      return p;
+  }
+
+  return 17;
+}
+
+static void round_trip(double v) {
+  char dst[DT_BUF_SIZE + 1];
+  size_t len = dt_format(dst, v);
+  assert(len < sizeof dst);
+  dst[len] = '\0';
+
+  uint64_t want, got;
+  double back = strtod(dst, NULL);
+  memcpy(&want, &v, sizeof v);
+  memcpy(&got, &back, sizeof back);
+  if (want != got) {
+    fprintf(stderr, "dt_format(%a) = \"%s\" reads back as %a\n", v, dst, back);
+    abort();
+  }
+
+  int32_t exp;
+  len = dt_format_sci(dst, v, &exp);
+  dst[len] = '\0';
+
+  size_t digits = 0;
+  for (char *c = dst; *c != '\0'; ++c)
+    digits += *c >= '0' && *c <= '9';
+
+  if ((int)digits != shortest(v)) {
+    fprintf(stderr, "dt_format_sci(%a) = \"%s\" is not shortest\n", v, dst);
+    abort();
+  }
+
+  snprintf(dst + len, sizeof dst - len, "e%d", exp);
+  assert(strtod(dst, NULL) == v);
+}
+
+int main() {
+  expect(0.0, "0");
+  expect(-0.0, "-0");
+  expect(INFINITY, "inf");
+  expect(-INFINITY, "-inf");
+  expect(NAN, "nan");
+  expect(1, "1");
+  expect(-2, "-2");
+  expect(5, "5");
+  expect(0.1, "0.1");
+  expect(0.3, "0.3");
+  expect(0.1 + 0.2, "0.30000000000000004");
+  expect(1.5, "1.5");
+  expect(123.456, "123.456");
+  expect(1e-6, "0.000001");
+  expect(1.5e-7, "1.5e-7");
+  expect(1e20, "100000000000000000000");
+  expect(1e21, "1e+21");
+  expect(M_PI, "3.141592653589793");
+  expect(5e-324, "5e-324");
+  expect(1.7976931348623157e308, "1.7976931348623157e+308");
+  expect(2.2250738585072014e-308, "2.2250738585072014e-308");
+  expect(9007199254740993.0, "9007199254740992");
+  expect(3628800, "3628800");
+
+  int32_t exp;
+  char dst[DT_BUF_SIZE];
+  assert(dt_format_sci(dst, 4.440892098500626e-16, &exp) == 17);
+  assert(memcmp(dst, "4.440892098500626", 17) == 0 && exp == -16);
+  assert(dt_format_sci(dst, 100, &exp) == 1 && dst[0] == '1' && exp == 2);
+
+  // random bit patterns cover every exponent, including subnormals;
+  for (int i = 0; i < 200000; ++i) {
+    uint64_t bits = rng_next();
+    double v;
+    memcpy(&v, &bits, sizeof v);
+    if (isfinite(v) && v != 0)
+      round_trip(v);
+  }
+
+  // short decimals and integers hit the trailing zeros paths;
+  for (int i = 0; i < 200000; ++i) {
+    double v = (double)(rng_next() % 100000000) / pow(10, rng_next() % 12);
+    if (v != 0)
+      round_trip(v);
+    round_trip((double)(rng_next() >> (rng_next() % 64)) + 1);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 
 #include "generic_init.h"
 
+#include <assert.h>
 #include <stdlib.h>
 
 typedef struct {
@@ -41,6 +42,14 @@ G_TYPED(st_add_)(G_TYPED(Stack_) *restrict st, G_TYPE v) {
   return G_ERROR(_NOERROR);
 }
 
+// st_put_ - same as st_add_, but capacity is reserved by caller;
+static inline void G_TYPED(st_put_)(G_TYPED(Stack_) *restrict st, G_TYPE v) {
+  assert(st->len < st->cap);
+
+  st->data[st->len] = v;
+  ++st->len;
+}
+
 static inline G_RETURN_TYPE
 G_TYPED(st_pop_)(G_TYPED(Stack_) *restrict st, G_TYPE *v) {
   if (st->len == 0)
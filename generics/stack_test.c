@@ -43,6 +43,8 @@ int main(void) {
   assert(foo(st, &a) == TEST_ERR_G_ST_FULL && a == 13 && st->len == 3);
   st_pop_int(st, &a);
   assert(a == 11 && st->len == 2);
+  st_put_int(st, 14);
+  assert(foo(st, &a) == TEST_ERR_G_ST_FULL && a == 14 && st->len == 3);
 
 	free(st);
 
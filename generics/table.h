@@ -35,6 +35,8 @@ typedef struct {
 
 //=:hmap:get
 
+// map_get - sets *val to value of key. Entries of a key are never behind an
+// empty one, see map_pop, so a missing key is found out by its probe length;
 static inline G_RETURN_TYPE
 G_TYPED(map_get_)(G_TYPED(Map_Entry_) m[restrict static 1], size_t cap, uint64_t key, G_TYPE *val) {
   size_t index = key % cap;
@@ -46,6 +48,9 @@ G_TYPED(map_get_)(G_TYPED(Map_Entry_) m[restrict static 1], size_t cap, uint64_t
       return G_ERROR(_NOERROR);
     }
 
+    if (m[index].key == 0)
+      break;
+
     index = (index + 1) % cap;
     ++steps;
   } while (steps < cap);
@@ -76,22 +81,46 @@ G_TYPED(map_set_)(G_TYPED(Map_Entry_) m[restrict static 1], size_t cap, uint64_t
 
 //=:hmap:pop
 
+// map_pop - removes key in any order. Every later entry up to an empty one,
+// which would be probed past the entry left empty, is moved into it and
+// leaves its own entry empty instead, so no probe crosses an empty entry;
 static inline G_RETURN_TYPE
 G_TYPED(map_pop_)(G_TYPED(Map_Entry_) m[restrict static 1], size_t cap, uint64_t key) {
   size_t index = key % cap;
   size_t steps = 0;
 
-  do {
-    if (m[index].key == key) {
-      m[index].key = 0;
-      return G_ERROR(_NOERROR);
-    }
+  while (m[index].key != key) {
+    if (m[index].key == 0 || ++steps == cap)
+      return G_ERROR(_G_HM_NOT_FOUND);
 
     index = (index + 1) % cap;
-    ++steps;
-  } while (steps < cap);
+  }
+
+  size_t next = (index + 1) % cap;
+  for (steps = 1; steps < cap && m[next].key != 0; ++steps) {
+    // entry stays, when it is probed from an index in (index, next];
+    size_t dist = (next + cap - m[next].key % cap) % cap;
+    if (dist >= (next + cap - index) % cap) {
+      m[index] = m[next];
+      index = next;
+    }
 
-  return G_ERROR(_G_HM_NOT_FOUND);
+    next = (next + 1) % cap;
+  }
+
+  m[index].key = 0;
+  return G_ERROR(_NOERROR);
+}
+
+//=:hmap:dist
+
+// map_dist - returns probe length of entry at index or 0 if it is empty;
+static inline size_t
+G_TYPED(map_dist_)(G_TYPED(Map_Entry_) m[restrict static 1], size_t cap, size_t index) {
+  if (m[index].key == 0)
+    return 0;
+
+  return (index + cap - m[index].key % cap) % cap + 1;
 }
 
 #undef G_TYPE
@@ -17,7 +17,7 @@ typedef enum {
 #include "table.h"
 
 Map_Entry_int *hm_new_int(size_t length) {
-  Map_Entry_int *st = malloc(sizeof(Map_Entry_int) + length * sizeof(int));
+  Map_Entry_int *st = calloc(length, sizeof(Map_Entry_int));
 
   return st;
 }
@@ -45,6 +45,53 @@ int main() {
 	assert(map_get_int(entries, N, 990900900090000, &a) == TEST_ERR_G_HM_NOT_FOUND && a == 11111);
 	assert(map_get_int(entries, N, 123456789123456789, &a) == TEST_ERR_NOERROR && a == 144);
 
+	assert(map_dist_int(entries, N, 4) == 1); // 34
+	assert(map_dist_int(entries, N, 0) == 2); // 123456789123456789
+	assert(map_dist_int(entries, N, 2) == 0); // 990900900090000 (popped)
+
+  free(entries);
+
+  // keys are popped in any order, the rest of their runs is moved back;
+  entries = hm_new_int(N);
+
+  assert(map_set_int(entries, N, 5, 50) == TEST_ERR_NOERROR);
+  assert(map_set_int(entries, N, 1, 10) == TEST_ERR_NOERROR);
+  assert(map_set_int(entries, N, 10, 100) == TEST_ERR_NOERROR);
+  assert(map_set_int(entries, N, 15, 150) == TEST_ERR_NOERROR);
+
+  assert(map_pop_int(entries, N, 5) == TEST_ERR_NOERROR);
+  assert(map_get_int(entries, N, 10, &a) == TEST_ERR_NOERROR && a == 100);
+  assert(map_get_int(entries, N, 15, &a) == TEST_ERR_NOERROR && a == 150);
+  assert(map_get_int(entries, N, 5, &a) == TEST_ERR_G_HM_NOT_FOUND);
+
+  assert(map_dist_int(entries, N, 0) == 1); // 10
+  assert(map_dist_int(entries, N, 1) == 1); // 1
+  assert(map_dist_int(entries, N, 2) == 3); // 15
+  assert(map_dist_int(entries, N, 3) == 0);
+
+  assert(map_pop_int(entries, N, 1) == TEST_ERR_NOERROR);
+  assert(map_pop_int(entries, N, 1) == TEST_ERR_G_HM_NOT_FOUND);
+  assert(map_dist_int(entries, N, 1) == 2); // 15
+  assert(map_set_int(entries, N, 15, 151) == TEST_ERR_NOERROR);
+  assert(map_pop_int(entries, N, 15) == TEST_ERR_NOERROR);
+  assert(map_get_int(entries, N, 15, &a) == TEST_ERR_G_HM_NOT_FOUND);
+
+  free(entries);
+
+  // runs wrap around the end of table;
+  entries = hm_new_int(N);
+
+  assert(map_set_int(entries, N, 4, 40) == TEST_ERR_NOERROR);
+  assert(map_set_int(entries, N, 9, 90) == TEST_ERR_NOERROR);
+  assert(map_set_int(entries, N, 14, 140) == TEST_ERR_NOERROR);
+
+  assert(map_pop_int(entries, N, 4) == TEST_ERR_NOERROR);
+  assert(map_get_int(entries, N, 9, &a) == TEST_ERR_NOERROR && a == 90);
+  assert(map_get_int(entries, N, 14, &a) == TEST_ERR_NOERROR && a == 140);
+  assert(map_dist_int(entries, N, 4) == 1); // 9
+  assert(map_dist_int(entries, N, 0) == 2); // 14
+  assert(map_dist_int(entries, N, 1) == 0);
+
   free(entries);
 	return 0;
 }
@@ -0,0 +1,372 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef GRID_H
+#define GRID_H
+
+// grid - evaluates a program at every point of a grid of one or two axes.
+//
+// Points are written in row-major order, the first axis runs along rows. A
+// grid is evaluated in bands of at most GRID_BAND_POINTS points, every band is
+// split into tiles of GRID_TILE_ROWS x GRID_TILE_COLS points evaluated by
+// threads of a pool, each with its own handle, and is written when all of its
+// tiles are done. Points where evaluation fails are NaN.
+
+#include "config.h"
+
+#include "mewa.h"
+
+#include "output.h"
+#include "pool.h"
+#include "util.h"
+
+#include <complex.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//=:grid:grid
+
+typedef struct {
+  const char *name;
+  double from;
+  double to;
+  size_t count;
+} Grid_Axis;
+
+typedef enum {
+  GF_CSV,
+  GF_BINARY,
+  GF_PPM,
+} Grid_Format;
+
+// Grid - axes of grid. Two axes of one variable are its real and imaginary
+// parts, plane is set then;
+typedef struct {
+  Grid_Axis axes[2];
+  unsigned axes_len;
+  bool plane;
+  Grid_Format format;
+} Grid;
+
+// grid_parse_axis - parses NAME=FROM:TO:COUNT, spec is split in place;
+static inline bool grid_parse_axis(Grid_Axis *axis, char *spec) {
+  char *eq = strchr(spec, '=');
+  if (eq == NULL || eq == spec)
+    return false;
+  *eq = '\0';
+  axis->name = spec;
+
+  char *end;
+  axis->from = strtod(eq + 1, &end);
+  if (end == eq + 1 || *end != ':')
+    return false;
+
+  char *to = end + 1;
+  axis->to = strtod(to, &end);
+  if (end == to || *end != ':')
+    return false;
+
+  char *count = end + 1;
+  unsigned long long n = strtoull(count, &end, 10);
+  if (end == count || *end != '\0' || n == 0 || n > GRID_AXIS_MAX)
+    return false;
+  axis->count = n;
+
+  return isfinite(axis->from) && isfinite(axis->to);
+}
+
+// grid_parse - parses comma separated axes, spec is split in place;
+static inline bool grid_parse(Grid *grid, char *spec) {
+  char *second = strchr(spec, ',');
+  if (second != NULL)
+    *second++ = '\0';
+
+  grid->axes_len = 1 + (second != NULL);
+  if (!grid_parse_axis(&grid->axes[0], spec) ||
+      (second != NULL && !grid_parse_axis(&grid->axes[1], second)))
+    return false;
+
+  grid->plane = grid->axes_len == 2 &&
+                  strcmp(grid->axes[0].name, grid->axes[1].name) == 0;
+  return true;
+}
+
+// grid_coord - returns coordinate of point i of axis;
+static inline double grid_coord(const Grid_Axis *axis, size_t i) {
+  if (axis->count == 1)
+    return axis->from;
+
+  return axis->from + (axis->to - axis->from) * (double)i / (axis->count - 1);
+}
+
+static inline size_t grid_rows(const Grid *grid) {
+  return grid->axes_len == 2 ? grid->axes[1].count : 1;
+}
+
+// grid_row_coord - returns coordinate of row, images put the last one on top;
+static inline double grid_row_coord(const Grid *grid, size_t row) {
+  if (grid->axes_len == 1)
+    return 0;
+
+  if (grid->format == GF_PPM)
+    row = grid->axes[1].count - 1 - row;
+  return grid_coord(&grid->axes[1], row);
+}
+
+//=:grid:evaluation
+
+// Grid_Band - rectangle of grid evaluated at once, it spans whole rows or a
+// part of one row;
+typedef struct {
+  const Grid *grid;
+  const Mewa_Program *program;
+  Mewa **handles;
+
+  size_t row;
+  size_t col;
+  size_t rows;
+  size_t cols;
+  size_t tiles_per_row;
+
+  Mewa_Value *values;
+
+  // failed points of every worker and error of the first of them;
+  size_t *failed;
+  size_t *failed_first;
+  int *failed_code;
+} Grid_Band;
+
+static inline void grid_eval_point(Grid_Band *band, Mewa *m, unsigned worker,
+                                   size_t row, size_t col) {
+  const Grid *grid = band->grid;
+  Mewa_Value *value = &band->values[(row - band->row) * band->cols + col -
+                                    band->col];
+
+  double x = grid_coord(&grid->axes[0], col);
+  double y = grid_row_coord(grid, row);
+
+  int err;
+  if (grid->plane) {
+    err = mewa_bind(m, grid->axes[0].name, x, y);
+  } else {
+    err = mewa_bind(m, grid->axes[0].name, x, 0);
+    if (err == MEWA_OK && grid->axes_len == 2)
+      err = mewa_bind(m, grid->axes[1].name, y, 0);
+  }
+
+  if (err == MEWA_OK)
+    err = mewa_eval(m, band->program, value);
+  if (err == MEWA_OK && value->type != MEWA_NONE)
+    return;
+
+  *value = (Mewa_Value){.type = MEWA_NONE, .real = NAN, .imag = NAN};
+
+  size_t point = row * grid->axes[0].count + col;
+  if (band->failed[worker]++ == 0 || point < band->failed_first[worker]) {
+    band->failed_first[worker] = point;
+    band->failed_code[worker] = err;
+  }
+}
+
+static inline void grid_tile(void *ctx, unsigned worker, size_t chunk) {
+  Grid_Band *band = ctx;
+  Mewa *m = band->handles[worker];
+
+  size_t row = band->row + chunk / band->tiles_per_row * GRID_TILE_ROWS;
+  size_t col = band->col + chunk % band->tiles_per_row * GRID_TILE_COLS;
+  size_t row_end = MIN(row + GRID_TILE_ROWS, band->row + band->rows);
+  size_t col_end = MIN(col + GRID_TILE_COLS, band->col + band->cols);
+
+  for (size_t r = row; r < row_end; ++r)
+    for (size_t c = col; c < col_end; ++c)
+      grid_eval_point(band, m, worker, r, c);
+}
+
+//=:grid:output
+
+// grid_color - writes domain coloring of value: hue is its argument and
+// lightness grows with its modulus from black at zeros to white at poles;
+static inline void grid_color(const Mewa_Value *value, char rgb[static 3]) {
+  cmx_t v = CMPLX(value->real, value->imag);
+  if (isnan(value->real) || isnan(value->imag)) {
+    memset(rgb, 0x80, 3);
+    return;
+  }
+
+  // hue in sixths of turn, red for positive reals;
+  double hue = fmod(carg(v) + 2 * M_PI, 2 * M_PI) / (2 * M_PI) * 6;
+  double light = isinf(cabs(v)) ? 1 : atan(cabs(v)) * 2 / M_PI;
+  double chroma = 1 - fabs(2 * light - 1);
+
+  // channels follow hue at offsets of red, green and blue;
+  static const double offsets[3] = {0, 8, 4};
+
+  for (int i = 0; i < 3; ++i) {
+    double k = fmod(offsets[i] + hue * 2, 12);
+    double c = light - chroma / 2 * MAX(-1, MIN(MIN(k - 3, 9 - k), 1));
+    rgb[i] = (char)lround(c * 255);
+  }
+}
+
+static inline void grid_write_header(const Grid *grid) {
+  switch (grid->format) {
+  case GF_CSV:
+    if (grid->plane) {
+      out_fmt("re(%s),im(%s),", grid->axes[0].name, grid->axes[0].name);
+    } else {
+      for (unsigned i = 0; i < grid->axes_len; ++i)
+        out_fmt("%s,", grid->axes[i].name);
+    }
+    out_str("re,im,rel_err\n");
+    break;
+  case GF_PPM:
+    out_fmt("P6\n%zu %zu\n255\n", grid->axes[0].count, grid->axes[1].count);
+    break;
+  case GF_BINARY:
+    break;
+  }
+}
+
+static inline void grid_write_point(const Grid *grid, size_t row, size_t col,
+                                    const Mewa_Value *value) {
+  switch (grid->format) {
+  case GF_CSV:
+    out_dbl(grid_coord(&grid->axes[0], col));
+    out_chr(',');
+    if (grid->axes_len == 2) {
+      out_dbl(grid_row_coord(grid, row));
+      out_chr(',');
+    }
+    out_dbl(value->real);
+    out_chr(',');
+    out_dbl(value->imag);
+    out_chr(',');
+    out_dbl(value->rel_err);
+    out_chr('\n');
+    break;
+  case GF_BINARY:
+    out_record(value->real, value->imag, value->rel_err,
+        value->type == MEWA_NUMBER ? OT_CMX
+        : value->type == MEWA_BOOL ? OT_PRB
+                                   : OT_NONE);
+    break;
+  case GF_PPM:
+    grid_color(value, out_reserve(3));
+    out_commit(3);
+    break;
+  }
+}
+
+//=:grid:run
+
+// grid_run - evaluates program over grid by threads handles and writes
+// points to output, handle m is used by the first thread;
+static inline void grid_run(Mewa *m, const Mewa_Program *program, Grid *grid,
+                            unsigned threads) {
+  if (threads == 0)
+    threads = pool_cpus();
+  threads = MIN(threads, GRID_THREADS_MAX);
+
+  Pool *pool = threads > 1 ? pool_new(threads) : NULL;
+  unsigned workers = pool != NULL ? pool_threads(pool) : 1;
+
+  size_t cols = grid->axes[0].count, rows = grid_rows(grid);
+  size_t band_cols = MIN(cols, GRID_BAND_POINTS);
+  size_t band_rows = MAX(GRID_BAND_POINTS / band_cols, 1);
+
+  Grid_Band band = {
+      .grid = grid,
+      .program = program,
+      .handles = calloc(workers, sizeof(Mewa *)),
+      .values = malloc(band_rows * band_cols * sizeof(Mewa_Value)),
+      .failed = calloc(workers, sizeof(size_t)),
+      .failed_first = calloc(workers, sizeof(size_t)),
+      .failed_code = calloc(workers, sizeof(int)),
+  };
+  if (band.handles == NULL || band.values == NULL || band.failed == NULL ||
+      band.failed_first == NULL || band.failed_code == NULL)
+    FATAL("cannot allocate grid\n");
+
+  band.handles[0] = m;
+  for (unsigned i = 1; i < workers; ++i)
+    if ((band.handles[i] = mewa_new()) == NULL)
+      FATAL("cannot allocate evaluation context\n");
+
+  // tiles are the parallelism, reductions of a point stay on its thread;
+  if (workers > 1)
+    for (unsigned i = 0; i < workers; ++i)
+      mewa_threads(band.handles[i], 1);
+
+  grid_write_header(grid);
+
+  for (band.row = 0; band.row < rows; band.row += band.rows) {
+    band.rows = MIN(band_rows, rows - band.row);
+
+    for (band.col = 0; band.col < cols; band.col += band.cols) {
+      band.cols = MIN(band_cols, cols - band.col);
+      band.tiles_per_row = (band.cols + GRID_TILE_COLS - 1) / GRID_TILE_COLS;
+
+      size_t tiles = band.tiles_per_row *
+                     ((band.rows + GRID_TILE_ROWS - 1) / GRID_TILE_ROWS);
+      if (pool != NULL) {
+        pool_run(pool, tiles, grid_tile, &band);
+      } else {
+        for (size_t i = 0; i < tiles; ++i)
+          grid_tile(&band, 0, i);
+      }
+
+      for (size_t r = 0; r < band.rows; ++r)
+        for (size_t c = 0; c < band.cols; ++c)
+          grid_write_point(grid, band.row + r, band.col + c,
+              &band.values[r * band.cols + c]);
+    }
+  }
+
+  size_t failed = 0, first = 0;
+  int code = MEWA_OK;
+  for (unsigned i = 0; i < workers; ++i) {
+    if (band.failed[i] != 0 && (failed == 0 || band.failed_first[i] < first)) {
+      first = band.failed_first[i];
+      code = band.failed_code[i];
+    }
+    failed += band.failed[i];
+  }
+
+  out_flush();
+  if (failed != 0)
+    WARNING("%zu of %zu points have no value, the first: %s\n", failed,
+        rows * cols, code != MEWA_OK ? mewa_strerror(code) : "no result");
+
+  for (unsigned i = 1; i < workers; ++i)
+    mewa_free(band.handles[i]);
+  pool_free(pool);
+
+  free(band.handles);
+  free(band.values);
+  free(band.failed);
+  free(band.failed_first);
+  free(band.failed_code);
+}
+
+#endif
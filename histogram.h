@@ -0,0 +1,155 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//=:histogram:histogram
+
+// every power of two is split into 2^HIST_SUB_BITS buckets, so a value is
+// reported with relative error below 1 / 2^HIST_SUB_BITS;
+#define HIST_SUB_BITS (3)
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+// Histogram - distribution of latencies in nanoseconds;
+typedef struct {
+  uint64_t count;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+  uint64_t buckets[HIST_BUCKETS];
+} Histogram;
+
+static inline uint64_t hist_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static inline size_t hist_index(uint64_t v) {
+  if (v < HIST_SUB)
+    return v;
+
+  unsigned e = 63 - __builtin_clzll(v);
+  return (e - HIST_SUB_BITS + 1) * HIST_SUB +
+         ((v >> (e - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+// hist_lower - returns the least value of bucket;
+static inline uint64_t hist_lower(size_t index) {
+  if (index < HIST_SUB)
+    return index;
+
+  unsigned e = index / HIST_SUB + HIST_SUB_BITS - 1;
+  return (uint64_t)(HIST_SUB + index % HIST_SUB) << (e - HIST_SUB_BITS);
+}
+
+static inline void hist_add(Histogram *h, uint64_t v) {
+  if (h->count == 0 || v < h->min)
+    h->min = v;
+  if (v > h->max)
+    h->max = v;
+
+  ++h->count;
+  h->sum += v;
+  ++h->buckets[hist_index(v)];
+}
+
+static inline void hist_merge(Histogram *dst, const Histogram *src) {
+  if (src->count == 0)
+    return;
+
+  if (dst->count == 0 || src->min < dst->min)
+    dst->min = src->min;
+  if (src->max > dst->max)
+    dst->max = src->max;
+
+  dst->count += src->count;
+  dst->sum += src->sum;
+  for (size_t i = 0; i < HIST_BUCKETS; ++i)
+    dst->buckets[i] += src->buckets[i];
+}
+
+// hist_quantile - returns upper bound of the value of rank q * count;
+static inline uint64_t hist_quantile(const Histogram *h, double q) {
+  uint64_t rank = (uint64_t)(q * h->count), seen = 0;
+
+  for (size_t i = 0; i < HIST_BUCKETS; ++i) {
+    seen += h->buckets[i];
+    if (seen > rank) {
+      uint64_t upper = i + 1 < HIST_BUCKETS ? hist_lower(i + 1) - 1 : UINT64_MAX;
+      return upper < h->max ? upper : h->max;
+    }
+  }
+
+  return h->max;
+}
+
+// hist_print - prints summary and distribution over powers of two, in
+// microseconds;
+static inline void hist_print(const Histogram *h, FILE *file, const char *name) {
+  fprintf(file, "%s: %llu requests", name, (unsigned long long)h->count);
+  if (h->count == 0) {
+    fputc('\n', file);
+    return;
+  }
+
+  fprintf(file,
+      ", mean %.3fus\n"
+      "  min %.3fus, p50 %.3fus, p90 %.3fus, p99 %.3fus, p99.9 %.3fus, "
+      "max %.3fus\n",
+      (double)h->sum / h->count / 1e3, h->min / 1e3,
+      hist_quantile(h, 0.5) / 1e3, hist_quantile(h, 0.9) / 1e3,
+      hist_quantile(h, 0.99) / 1e3, hist_quantile(h, 0.999) / 1e3,
+      h->max / 1e3);
+
+  uint64_t octaves[64] = {0}, peak = 0;
+  for (size_t i = 0; i < HIST_BUCKETS; ++i) {
+    if (h->buckets[i] == 0)
+      continue;
+
+    uint64_t lower = hist_lower(i);
+    size_t octave = lower ? 63 - __builtin_clzll(lower) : 0;
+    octaves[octave] += h->buckets[i];
+    if (octaves[octave] > peak)
+      peak = octaves[octave];
+  }
+
+  for (size_t i = 0; i < 64; ++i) {
+    if (octaves[i] == 0)
+      continue;
+
+    char bar[41];
+    size_t len = octaves[i] * (sizeof bar - 1) / peak;
+    memset(bar, '#', len);
+    bar[len] = '\0';
+
+    fprintf(file, "  < %12.3fus %10llu %s\n", (double)(2ull << i) / 1e3,
+        (unsigned long long)octaves[i], bar);
+  }
+}
+
+#endif
@@ -155,7 +155,7 @@ static inline bool map_set(Map_Entry *restrict entries, size_t entries_cap,
 
 //=:hmap:pop:acsl
 // map_pop - sets \*entries.key to 0 where key = entries.key;
-// must be called in reversed order of corresponding keys setting.
+// later entries of its run are moved back, so it is called in any order.
 /* TODO: add ACSL annotation
 */
 //=:hmap:pop
@@ -167,19 +167,31 @@ static inline bool map_pop(Map_Entry *restrict entries, size_t entries_cap,
   size_t entry_len =
       align(sizeof(Map_Entry) + val_sz, sizeof(Map_Entry)) / sizeof(Map_Entry);
 
-  do {
-    Map_Entry *entry = &entries[index * entry_len];
+  while (entries[index * entry_len].key != key) {
+    if (entries[index * entry_len].key == 0 || ++steps == entries_cap)
+      return false;
 
-    if (entry->key == key) {
-      entry->key = 0;
-      return true;
+    index = (index + 1) % entries_cap;
+  }
+
+  size_t next = (index + 1) % entries_cap;
+  for (steps = 1; steps < entries_cap; ++steps) {
+    Map_Entry *entry = &entries[next * entry_len];
+    if (entry->key == 0)
+      break;
+
+    // entry stays, when it is probed from an index in (index, next];
+    size_t dist = (next + entries_cap - entry->key % entries_cap) % entries_cap;
+    if (dist >= (next + entries_cap - index) % entries_cap) {
+      memcpy(&entries[index * entry_len], entry, entry_len * sizeof(Map_Entry));
+      index = next;
     }
 
-    index = (index + 1) % entries_cap;
-    ++steps;
-  } while (steps < entries_cap);
+    next = (next + 1) % entries_cap;
+  }
 
-  return false;
+  entries[index * entry_len].key = 0;
+  return true;
 }
 
 #define SET_POP(entries, cap, key) map_pop(entries, cap, key, 0)
@@ -0,0 +1,6079 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+//=:includes
+#include "config.h"
+
+#include "mewa.h"
+
+#include "generics/generic.h"
+
+#include "util.h"
+
+#include "dtoa.h"
+#include "pool.h"
+#include "probes.h"
+#include "stats.h"
+
+#include <assert.h>
+#include <complex.h>
+#include <ctype.h>
+#include <float.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h> // IWYU pragma: keep
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <sys/resource.h>
+#endif
+
+//=:config:invariant
+
+_Static_assert(INTERNAL_READING_BUF_SIZE > 0,
+    "INTERNAL_READING_BUF_SIZE must be at least 1");
+
+_Static_assert(NODE_BUF_SIZE > 0, "NODE_BUF_SIZE must be at least 1");
+
+_Static_assert(GLOBAL_SCOPE_CAPACITY >= 4, "not enough capacity for builtins");
+
+_Static_assert((FUNCTION_MEMO_CAPACITY & (FUNCTION_MEMO_CAPACITY - 1)) == 0,
+    "FUNCTION_MEMO_CAPACITY must be 2^n");
+
+//=:reader:reader
+
+typedef struct {
+  String_Buffer page;
+
+  FILE *src;
+  Stats *stats;
+
+  size_t ptr;
+  size_t mrk;
+  size_t row;
+  size_t col;
+
+  char cch;
+
+  bool eof;
+  bool eos;
+  bool eoi;
+  bool prv;
+
+  // set when reading of src failed, input is treated as ended;
+  bool failed;
+} Reader;
+
+static void rd_reset_counters(Reader *rd) {
+  rd->ptr = 0;
+  rd->mrk = 0;
+  rd->row = 0;
+  rd->col = 0;
+  rd->eof = false;
+  rd->eos = false;
+  rd->eoi = false;
+  rd->prv = false;
+  rd->failed = false;
+}
+
+static void rd_prev(Reader *rd) {
+  rd->prv = rd->mrk == SIZE_MAX || rd->mrk != rd->ptr;
+}
+
+static void rd_next_page(Reader *rd) {
+  rd->ptr = 0;
+  rd->mrk = SIZE_MAX;
+
+  if (rd->src == NULL) {
+    rd->eos = rd->eof = rd->eoi;
+    return;
+  }
+
+  STATS_CLOCK_BEGIN(rd->stats, start, CLOCK_MONOTONIC);
+  rd->page.len = fread(rd->page.data, sizeof(char), rd->page.cap, rd->src);
+  if (ferror(rd->src)) {
+    rd->failed = true;
+    rd->page.len = 0;
+  }
+  STATS_CLOCK_END(rd->stats, start, CLOCK_MONOTONIC, wall_ns[SP_READ]);
+
+  rd->eof = rd->page.len < rd->page.cap;
+  if ((rd->eos = !rd->page.len))
+    rd->cch = '\0';
+}
+
+static void rd_next_char(Reader *rd) {
+  if (rd->prv) {
+    rd->prv = false;
+    return;
+  }
+
+  ++rd->col;
+  if (rd->ptr < rd->page.len && rd->page.data[rd->ptr] == '\n') {
+    rd->col = 0;
+    ++rd->row;
+  }
+  ++rd->ptr;
+
+  if (rd->ptr >= rd->page.len || (rd->src == NULL && !rd->eoi)) {
+    if (rd->eof || (rd->src == NULL && rd->eoi)) {
+      rd->eos = true;
+      rd->cch = '\0';
+      return;
+    }
+    rd_next_page(rd);
+    rd->eoi = true;
+  }
+
+  // source strings are not required to be terminated;
+  rd->cch = rd->ptr < rd->page.len ? rd->page.data[rd->ptr] : '\0';
+}
+
+static void rd_skip_whitespaces(Reader *rd) {
+  while (isspace(rd->cch))
+    rd_next_char(rd);
+}
+
+//=:lexer:interner
+
+// builtin symbols are interned before any other identifier in order of this
+// enumeration, so their symbols are constants;
+enum {
+  BUILTIN_CONST_PI = 1,
+  BUILTIN_CONST_E,
+  BUILTIN_SQRT,
+  BUILTIN_CEIL,
+  BUILTIN_ROUND,
+  BUILTIN_FLOOR,
+  BUILTIN_LN,
+  BUILTIN_EXP,
+  BUILTIN_COS,
+  BUILTIN_SIN,
+  BUILTIN_TAN,
+  BUILTIN_COSH,
+  BUILTIN_SINH,
+  BUILTIN_TANH,
+  BUILTIN_ACOS,
+  BUILTIN_ASIN,
+  BUILTIN_ATAN,
+  BUILTIN_ACOSH,
+  BUILTIN_ASINH,
+  BUILTIN_ATANH,
+  BUILTIN_SUM,
+  BUILTIN_PROD,
+  BUILTIN_MIN,
+  BUILTIN_MAX,
+  BUILTIN_SOLVE,
+  BUILTIN_INTEGRATE,
+  BUILTIN_COUNT,
+};
+
+static const char *const builtin_names[BUILTIN_COUNT] = {
+    [BUILTIN_CONST_PI] = "pi",
+    [BUILTIN_CONST_E] = "e",
+    [BUILTIN_SQRT] = "sqrt",
+    [BUILTIN_CEIL] = "ceil",
+    [BUILTIN_ROUND] = "round",
+    [BUILTIN_FLOOR] = "floor",
+    [BUILTIN_LN] = "ln",
+    [BUILTIN_EXP] = "exp",
+    [BUILTIN_COS] = "cos",
+    [BUILTIN_SIN] = "sin",
+    [BUILTIN_TAN] = "tan",
+    [BUILTIN_COSH] = "cosh",
+    [BUILTIN_SINH] = "sinh",
+    [BUILTIN_TANH] = "tanh",
+    [BUILTIN_ACOS] = "acos",
+    [BUILTIN_ASIN] = "asin",
+    [BUILTIN_ATAN] = "atan",
+    [BUILTIN_ACOSH] = "acosh",
+    [BUILTIN_ASINH] = "asinh",
+    [BUILTIN_ATANH] = "atanh",
+    [BUILTIN_SUM] = "sum",
+    [BUILTIN_PROD] = "prod",
+    [BUILTIN_MIN] = "min",
+    [BUILTIN_MAX] = "max",
+    [BUILTIN_SOLVE] = "solve",
+    [BUILTIN_INTEGRATE] = "integrate",
+};
+
+typedef struct {
+  uint64_t hash;
+  uint32_t len;
+  const char *name;
+} Intern_Entry;
+
+// Interner - identifiers of a handle. Every identifier is numbered by a
+// symbol once, so scopes hash and compare symbols instead of names. Entries
+// and names are kept in blocks which never move, so a name of a symbol is read
+// by programs of the handle on any thread, only the handle interns. Programs
+// keep references to interner of their handle, it is freed with the last of
+// them, and reset of the handle starts a new one. Symbol 0 is never given;
+typedef struct {
+  atomic_uint refs;
+  sym_t len;
+  Intern_Entry *entries[INTERN_SYMBOLS_MAX / INTERN_BLOCK_SYMBOLS];
+
+  // blocks of names, each starts with pointer to the previous one;
+  char *arenas;
+  char *arena;
+  size_t arena_left;
+
+  // open addressing table of symbols by hashes of their names;
+  sym_t *index;
+  size_t index_cap;
+} Interner;
+
+static inline uint64_t intern_hash(const char *name, uint32_t len) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (uint32_t i = 0; i < len; ++i)
+    hash = (hash ^ (unsigned char)name[i]) * 0x100000001b3;
+  return hash;
+}
+
+static inline Intern_Entry *intern_entry(const Interner *in, sym_t sym) {
+  return &in->entries[sym / INTERN_BLOCK_SYMBOLS][sym % INTERN_BLOCK_SYMBOLS];
+}
+
+// intern_grow - doubles index, returns false if out of memory;
+static bool intern_grow(Interner *in) {
+  size_t cap = in->index_cap ? in->index_cap * 2 : INTERN_INDEX_CAPACITY;
+  sym_t *index = calloc(cap, sizeof(sym_t));
+  if (index == NULL)
+    return false;
+
+  for (sym_t sym = 1; sym < in->len; ++sym) {
+    size_t i = intern_entry(in, sym)->hash & (cap - 1);
+    while (index[i] != 0)
+      i = (i + 1) & (cap - 1);
+    index[i] = sym;
+  }
+
+  free(in->index);
+  in->index = index;
+  in->index_cap = cap;
+  return true;
+}
+
+// intern_add - numbers new identifier, returns 0 if out of memory;
+static sym_t intern_add(Interner *in, const char *name, uint32_t len,
+                        uint64_t hash) {
+  sym_t sym = in->len ? in->len : 1;
+  if (sym == INTERN_SYMBOLS_MAX)
+    return 0;
+
+  if ((sym + 1) * 2 > in->index_cap && !intern_grow(in))
+    return 0;
+
+  Intern_Entry **block = &in->entries[sym / INTERN_BLOCK_SYMBOLS];
+  if (*block == NULL && (*block = malloc(INTERN_BLOCK_SYMBOLS * sizeof(Intern_Entry))) == NULL)
+    return 0;
+
+  if (in->arena_left < len) {
+    size_t size = MAX(INTERN_ARENA_BLOCK, len);
+    char *arena = malloc(sizeof(char *) + size);
+    if (arena == NULL)
+      return 0;
+
+    memcpy(arena, &in->arenas, sizeof(char *));
+    in->arenas = arena;
+    in->arena = arena + sizeof(char *);
+    in->arena_left = size;
+  }
+
+  memcpy(in->arena, name, len);
+  (*block)[sym % INTERN_BLOCK_SYMBOLS] = (Intern_Entry){hash, len, in->arena};
+  in->arena += len;
+  in->arena_left -= len;
+  in->len = sym + 1;
+
+  size_t i = hash & (in->index_cap - 1);
+  while (in->index[i] != 0)
+    i = (i + 1) & (in->index_cap - 1);
+  in->index[i] = sym;
+
+  return sym;
+}
+
+static sym_t intern_find(const Interner *in, const char *name, uint32_t len,
+                         uint64_t hash) {
+  for (size_t i = hash & (in->index_cap - 1); in->index[i] != 0;
+       i = (i + 1) & (in->index_cap - 1)) {
+    const Intern_Entry *entry = intern_entry(in, in->index[i]);
+    if (entry->hash == hash && entry->len == len && memcmp(entry->name, name, len) == 0)
+      return in->index[i];
+  }
+
+  return 0;
+}
+
+// intern - returns symbol of identifier, or 0 if out of memory;
+static sym_t intern(Interner *in, const char *name, uint32_t len) {
+  uint64_t hash = intern_hash(name, len);
+
+  sym_t sym = intern_find(in, name, len, hash);
+  return sym != 0 ? sym : intern_add(in, name, len, hash);
+}
+
+// intern_name - returns name of symbol, which is not terminated;
+static const char *intern_name(const Interner *in, sym_t sym,
+                               uint32_t len[static 1]) {
+  const Intern_Entry *entry = intern_entry(in, sym);
+  *len = entry->len;
+  return entry->name;
+}
+
+// intern_translate - returns symbol of name of symbol of interner from in to,
+// or 0 if out of memory;
+static sym_t intern_translate(Interner *to, const Interner *from, sym_t sym) {
+  uint32_t len;
+  const char *name = intern_name(from, sym, &len);
+  return intern(to, name, len);
+}
+
+static void intern_unref(Interner *in) {
+  if (in == NULL ||
+      atomic_fetch_sub_explicit(&in->refs, 1, memory_order_acq_rel) != 1)
+    return;
+
+  for (size_t i = 0; i < sizeof in->entries / sizeof *in->entries; ++i)
+    free(in->entries[i]);
+
+  while (in->arenas != NULL) {
+    char *prev;
+    memcpy(&prev, in->arenas, sizeof(char *));
+    free(in->arenas);
+    in->arenas = prev;
+  }
+
+  free(in->index);
+  free(in);
+}
+
+static Interner *intern_ref(Interner *in) {
+  atomic_fetch_add_explicit(&in->refs, 1, memory_order_relaxed);
+  return in;
+}
+
+// intern_new - returns interner of builtin symbols only, in order of their
+// enumeration, or NULL if out of memory;
+static Interner *intern_new(void) {
+  Interner *in = calloc(1, sizeof(Interner));
+  if (in == NULL)
+    return NULL;
+
+  atomic_init(&in->refs, 1);
+  for (sym_t sym = 1; sym < BUILTIN_COUNT; ++sym) {
+    const char *name = builtin_names[sym];
+    if (intern_add(in, name, strlen(name), intern_hash(name, strlen(name))) != sym) {
+      intern_unref(in);
+      return NULL;
+    }
+  }
+
+  return in;
+}
+
+//=:lexer:lexer
+
+typedef struct {
+  Reader rd;
+
+  // identifiers of handle;
+  Interner *interner;
+
+  // position of the current token;
+  size_t row;
+  size_t col;
+
+  Token_Type tt;
+  float rel_err;
+  Primitive pm;
+} Lexer;
+
+static double lx_read_integer(Lexer *lx, double *log10, float *rel_err) {
+  long long test_integer = 0;
+  double integer = 0;
+  *log10 = 0;
+
+  while (isdigit(lx->rd.cch)) {
+    test_integer = test_integer * 10 + lx->rd.cch - '0';
+    integer = integer * 10 + lx->rd.cch - '0';
+    *log10 += 1;
+
+    rd_next_char(&lx->rd);
+  }
+
+  if (rel_err != NULL && integer < ldexp(1, 63) && integer != 0)
+    *rel_err = fabs((((long long)integer) - test_integer) / integer);
+
+  return integer;
+}
+
+static void lx_next_token_number(Lexer *lx) {
+  lx->tt = TT_ILL;
+
+  lx->rel_err = 0;
+
+  double decimal, decimal_log10, integer_log10;
+  lx->pm.c = lx_read_integer(lx, &integer_log10, &lx->rel_err);
+
+  if (lx->rd.cch == '.') {
+    rd_next_char(&lx->rd);
+
+    decimal = lx_read_integer(lx, &decimal_log10, NULL);
+    if (decimal_log10 == 0 && integer_log10 == 0)
+      return;
+    lx->pm.c += (double)decimal / pow(10, decimal_log10);
+
+    if (decimal != 0)
+      lx->rel_err += (float)((nextafter(creal(lx->pm.c), INFINITY) - creal(lx->pm.c)) / creal(lx->pm.c));
+  }
+
+  // exponent must have digits, since a number followed by a symbol is not a
+  // valid expression anyway;
+  if (lx->rd.cch == 'e' || lx->rd.cch == 'E') {
+    rd_next_char(&lx->rd);
+
+    bool negative = lx->rd.cch == '-';
+    if (lx->rd.cch == '-' || lx->rd.cch == '+')
+      rd_next_char(&lx->rd);
+
+    double exponent, exponent_log10;
+    exponent = lx_read_integer(lx, &exponent_log10, NULL);
+    if (exponent_log10 == 0)
+      return;
+
+    double scaled = creal(lx->pm.c) * pow(10, negative ? -exponent : exponent);
+    // powers of ten above 10^22 are not exact;
+    if (negative || exponent > 22 || scaled != floor(scaled))
+      lx->rel_err += (float)((nextafter(scaled, INFINITY) - scaled) / scaled);
+    lx->pm.c = scaled;
+  }
+
+  DBG_PRINT("rel_err: %e\n", lx->rel_err);
+
+  //  lx->rel_err = pow(10, -15);
+
+  lx->tt = TT_CMX;
+
+  if (lx->rd.cch == 'i') {
+    lx->pm.c = lx->pm.c * I;
+  } else {
+    rd_prev(&lx->rd);
+  }
+}
+
+// lx_next_token_symbol_from - reads the rest of identifier, whose first len
+// characters are already in name;
+static void lx_next_token_symbol_from(Lexer *lx, char name[static SYMBOL_NAME_MAX], size_t len) {
+  lx->tt = TT_ILL;
+
+  do {
+    // identifier is too long;
+    if (len == SYMBOL_NAME_MAX)
+      return;
+    name[len++] = lx->rd.cch;
+    rd_next_char(&lx->rd);
+  } while (isalpha(lx->rd.cch) || isdigit(lx->rd.cch));
+
+  rd_prev(&lx->rd);
+
+  lx->pm.s = intern(lx->interner, name, len);
+  if (lx->pm.s != 0)
+    lx->tt = TT_SYM;
+}
+
+static void lx_next_token_symbol(Lexer *lx) {
+  char name[SYMBOL_NAME_MAX];
+  lx_next_token_symbol_from(lx, name, 0);
+}
+
+static void lx_next_token_factorial(Lexer *lx, bool whitespace_prefix) {
+  lx->tt = TT_ILL;
+
+  unsigned c = 0;
+  for (; lx->rd.cch == '!'; ++c)
+    rd_next_char(&lx->rd);
+
+  lx->pm.c = (double)c;
+
+  if (c == 1 && lx->rd.cch == '=') {
+    lx->tt = TT_NEQ;
+    return;
+  }
+
+  if (c == 1 && !isspace(lx->rd.cch) && lx->rd.cch != '\0') {
+    lx->tt = TT_NOT;
+  } else if (!whitespace_prefix && (lx->rd.row != 0 || lx->rd.col != 2)) {
+    // rd.ptr is relative to the page, so position is used to make sure the
+    // token does not start the input;
+    lx->tt = TT_FAC;
+  }
+
+  rd_prev(&lx->rd);
+}
+
+#define LX_TRY_C(on_success_tt, fn, ...) \
+  {                                      \
+    if (fn) {                            \
+      lx->tt = on_success_tt;            \
+      __VA_ARGS__;                       \
+      return;                            \
+    }                                    \
+  }
+
+#define LX_LOOKUP(on_failure_tt, consumer) \
+  {                                        \
+    rd_next_char(&lx->rd);                 \
+    consumer;                              \
+    rd_prev(&lx->rd);                      \
+    lx->tt = on_failure_tt;                \
+  }
+
+static void lx_next_token_any(Lexer *lx) {
+  rd_next_char(&lx->rd);
+  bool whitespace_prefix = isspace(lx->rd.cch);
+  rd_skip_whitespaces(&lx->rd);
+
+  lx->rd.mrk = lx->rd.ptr;
+  lx->row = lx->rd.row;
+  lx->col = lx->rd.col;
+  lx->tt = TT_ILL;
+
+  switch (lx->rd.cch) {
+  case '+':  LX_LOOKUP(TT_NOP, LX_TRY_C(TT_ADD, isspace(lx->rd.cch), ) LX_TRY_C(TT_APX, lx->rd.cch == '/', )); break;
+  case '-':  LX_LOOKUP(TT_NEG, LX_TRY_C(TT_SPZ, lx->rd.cch == '>', ) LX_TRY_C(TT_SUB, isspace(lx->rd.cch), )); break;
+  case '*':  lx->tt = TT_MUL; break;
+  case '/':  lx->tt = TT_QUO; break;
+  case '%':  lx->tt = TT_MOD; break;
+  case '^':  lx->tt = TT_POW; break;
+  case '(':  lx->tt = TT_LP0; break;
+  case ')':  lx->tt = TT_RP0; break;
+  case ';':  lx->tt = TT_XPC; break;
+  case ',':  lx->tt = TT_SEP; break;
+  case '\0': lx->tt = TT_EOS; break;
+  case '!':  lx_next_token_factorial(lx, whitespace_prefix); break;
+  case '|':  lx->tt = TT_ABS; break;
+  case '>':  LX_LOOKUP(TT_GRE, LX_TRY_C(TT_GEQ, lx->rd.cch == '=', )); break;
+  case '<':  LX_LOOKUP(TT_LES, LX_TRY_C(TT_LEQ, lx->rd.cch == '=', )); break;
+  case '=':  LX_LOOKUP(TT_LET, LX_TRY_C(TT_EQU, lx->rd.cch == '=', )); break;
+  case 'i':
+    // i alone is the imaginary unit, otherwise it starts an identifier;
+    rd_next_char(&lx->rd);
+    if (isalpha(lx->rd.cch) || isdigit(lx->rd.cch)) {
+      char name[SYMBOL_NAME_MAX] = {'i'};
+      lx_next_token_symbol_from(lx, name, 1);
+      break;
+    }
+    rd_prev(&lx->rd);
+    lx->tt = TT_CMX;
+    lx->pm.c = I;
+    break;
+  default:
+    if (isdigit(lx->rd.cch) || lx->rd.cch == '.') {
+      lx_next_token_number(lx);
+    } else if (isalpha(lx->rd.cch)) {
+      lx_next_token_symbol(lx);
+    }
+  }
+}
+
+static void lx_next_token(Lexer *lx) {
+  STATS_CLOCK_BEGIN(lx->rd.stats, start, CLOCK_MONOTONIC);
+  lx_next_token_any(lx);
+  STATS_CLOCK_END(lx->rd.stats, start, CLOCK_MONOTONIC, wall_ns[SP_LEX]);
+  STATS_INC(lx->rd.stats, tokens);
+}
+
+//=:parser:nodes
+
+typedef uint32_t Node_Index;
+
+typedef struct {
+  Node_Index nhs;
+
+  union {
+    // slot NT_SAVE writes value of nhs to;
+    Slot slot;
+    // exponent NT_POWI raises value of nhs to;
+    uint32_t exp;
+    // coefficients of NT_POLY of value of nhs, from the highest degree, are
+    // literal nodes [coefs, coefs + degree];
+    struct {
+      Node_Index coefs;
+      uint32_t degree;
+    } poly;
+  };
+} Un_Op;
+
+typedef struct {
+  Node_Index lhs, rhs;
+
+  // nodes of rhs subtree, which is not always rooted at its last node;
+  Node_Index rhs_lower, rhs_upper;
+} Bi_Op;
+
+typedef struct {
+  uint32_t row;
+  uint32_t col;
+} Node_Pos;
+
+typedef struct Node {
+  Node_Type type : 16;
+  float rel_err;
+
+  union {
+    Primitive pm;
+    Un_Op up;
+    Bi_Op bp;
+  } as;
+} Node;
+
+typedef struct {
+  Node_Index node;
+  Node_Index depth;
+} Stack_Emu_El_nd_tree_print;
+
+static void nd_tree_print_dbl(FILE *file, double v) {
+  char dst[DT_BUF_SIZE];
+  fwrite(dst, 1, dt_format(dst, v), file);
+}
+
+static void nd_tree_print_cmx(FILE *file, cmx_t cmx, float rel_err) {
+  if (creal(cmx) != 0 && cimag(cmx) != 0) {
+    nd_tree_print_dbl(file, creal(cmx));
+    fputc(' ', file);
+    nd_tree_print_dbl(file, cimag(cmx));
+    fputc('i', file);
+  } else if (creal(cmx) == 0 && cimag(cmx) == 0) {
+    fputc('0', file);
+  } else if (creal(cmx) != 0) {
+    nd_tree_print_dbl(file, creal(cmx));
+  } else if (cimag(cmx) != 0) {
+    nd_tree_print_dbl(file, cimag(cmx));
+    fputc('i', file);
+  }
+
+  if (rel_err != 0)
+    fprintf(file, " +/- %.3e", (double)rel_err * fabs(cmx));
+
+  fputc('\n', file);
+}
+
+static void nd_tree_print(FILE *file, Stack_Emu_El_nd_tree_print stack_emu[], const Interner *in, const Node nodes[static 1], Node_Index node, Node_Index depth, Node_Index depth_max) {
+  Node_Index len = 1;
+
+  const char *name;
+  uint32_t name_len;
+
+  Node_Index node_tmp;
+
+  do {
+    while (depth < depth_max) {
+      fprintf(file, "%*s%s (%d) ", depth * 2, "",
+          nt_stringify(nodes[node].type), nodes[node].type);
+
+      switch (nodes[node].type) {
+      case NT_PRIM_SYM:
+        // shared values and parameters are read from slots of no symbol;
+        if (nodes[node].as.pm.s == 0) {
+          fprintf(file, "[%u]\n", nodes[node].as.pm.slot);
+          goto while2_final;
+        }
+
+        name = intern_name(in, nodes[node].as.pm.s, &name_len);
+        fprintf(file, "%.*s (%llu)\n", (int)name_len, name,
+            (unsigned long long)nodes[node].as.pm.s);
+        goto while2_final;
+      case NT_PRIM_CMX:
+        nd_tree_print_cmx(file, nodes[node].as.pm.c, nodes[node].rel_err);
+        goto while2_final;
+      case NT_PRIM_PRB:
+        nd_tree_print_dbl(file, creal(nodes[node].as.pm.c));
+        fputc('\n', file);
+        goto while2_final;
+      case NT_BIOP_LET:
+      case NT_BIOP_GRE:
+      case NT_BIOP_LES:
+      case NT_BIOP_GEQ:
+      case NT_BIOP_LEQ:
+      case NT_BIOP_EQU:
+      case NT_BIOP_NEQ:
+      case NT_BIOP_ADD:
+      case NT_BIOP_SUB:
+      case NT_BIOP_APX:
+      case NT_BIOP_MUL:
+      case NT_BIOP_QUO:
+      case NT_BIOP_MOD:
+      case NT_BIOP_POW:
+      case NT_BIOP_XPC:
+      case NT_BIOP_SEP:
+      case NT_BIOP_SPZ:
+      case NT_BIOP_FAC:
+      case NT_CALL:
+      case NT_REDUCE:
+      case NT_ELSE:
+      case NT_DEFINE:
+      case NT_APPLY:
+        fputc('\n', file);
+        node_tmp = node;
+        node = nodes[node_tmp].as.bp.lhs;
+        ++depth;
+        stack_emu[len].node = nodes[node_tmp].as.bp.rhs;
+        stack_emu[len].depth = depth;
+        ++len;
+        continue;
+      case NT_UNOP_ABS:
+      case NT_UNOP_NOT:
+      case NT_UNOP_NEG:
+      case NT_UNOP_NOP:
+        fputc('\n', file);
+        node = nodes[node].as.up.nhs;
+        ++depth;
+        continue;
+      case NT_SAVE:
+        fprintf(file, "[%u]\n", nodes[node].as.up.slot);
+        node = nodes[node].as.up.nhs;
+        ++depth;
+        continue;
+      case NT_POWI:
+        fprintf(file, "^%u\n", nodes[node].as.up.exp);
+        node = nodes[node].as.up.nhs;
+        ++depth;
+        continue;
+      case NT_POLY:
+        fprintf(file, "of degree %u\n", nodes[node].as.up.poly.degree);
+        node = nodes[node].as.up.nhs;
+        ++depth;
+        continue;
+      }
+    }
+
+    fprintf(file, "%*s...\n", depth * 2, "");
+
+  while2_final:
+    --len;
+    node = stack_emu[len].node;
+    depth = stack_emu[len].depth;
+  } while (len != 0);
+}
+
+#define nd_tree_print(file, in, nodes, node, depth, depth_max)          \
+  {                                                                    \
+    Stack_Emu_El_nd_tree_print stack_emu[depth_max - depth + 1];       \
+    nd_tree_print(file, stack_emu, in, nodes, node, depth, depth_max); \
+  }
+
+//=:parser:priorities
+
+// priorities of operators, from the weakest to the strongest binding;
+typedef enum {
+  PT_NONE,
+  PT_XPC,
+  PT_SEP,
+  PT_LET,
+  PT_SPZ,
+  PT_TEST,
+  PT_ADD_SUB,
+  PT_MUL_QUO_MOD,
+  PT_POW,
+  PT_FAC,
+  PT_CAL_APX,
+  PT_PRIM,
+} Priority;
+
+// tt_priorities - priorities of tokens in infix and postfix positions;
+static const Priority tt_priorities[] = {
+    [TT_XPC - TT_ILL] = PT_XPC,
+    [TT_SEP - TT_ILL] = PT_SEP,
+    [TT_LET - TT_ILL] = PT_LET,
+    [TT_SPZ - TT_ILL] = PT_SPZ,
+    [TT_GRE - TT_ILL] = PT_TEST,
+    [TT_LES - TT_ILL] = PT_TEST,
+    [TT_GEQ - TT_ILL] = PT_TEST,
+    [TT_LEQ - TT_ILL] = PT_TEST,
+    [TT_EQU - TT_ILL] = PT_TEST,
+    [TT_NEQ - TT_ILL] = PT_TEST,
+    [TT_ADD - TT_ILL] = PT_ADD_SUB,
+    [TT_NOP - TT_ILL] = PT_ADD_SUB,
+    [TT_SUB - TT_ILL] = PT_ADD_SUB,
+    [TT_NEG - TT_ILL] = PT_ADD_SUB,
+    [TT_MUL - TT_ILL] = PT_MUL_QUO_MOD,
+    [TT_QUO - TT_ILL] = PT_MUL_QUO_MOD,
+    [TT_MOD - TT_ILL] = PT_MUL_QUO_MOD,
+    [TT_POW - TT_ILL] = PT_POW,
+    [TT_NOT - TT_ILL] = PT_FAC,
+    [TT_FAC - TT_ILL] = PT_FAC,
+    [TT_LP0 - TT_ILL] = PT_CAL_APX,
+    [TT_APX - TT_ILL] = PT_CAL_APX,
+    [TT_ABS - TT_ILL] = PT_NONE,
+};
+
+static inline Priority pt_of_tt(Token_Type tt) {
+  return tt_priorities[tt - TT_ILL];
+}
+
+static inline bool pt_rl_biop(Priority pt) {
+  return pt == PT_LET || pt == PT_SPZ || pt == PT_POW;
+}
+
+static inline bool tt_is_unop(Token_Type tt) {
+  return tt == TT_NOT || tt == TT_NEG || tt == TT_NOP;
+}
+
+//=:errors
+
+#define G_RETURN_TYPE ERR
+
+typedef enum {
+  ERR_NOERROR,
+  ERR_RD_READ_FAILED,
+  ERR_PR_GENERAL,
+  ERR_PR_PAREN_NOT_OPENED,
+  ERR_PR_PAREN_NOT_CLOSED,
+  ERR_PR_TOKEN_UNEXPECTED,
+  ERR_PR_MEMORY_NOT_ENOUGH,
+  ERR_PR_UNEXPECTED_EXPRESSION,
+  ERR_PR_ARGS_MISMATCH,
+  ERR_PR_PARAM_REPEATED,
+  ERR_PR_BUILTIN_REDEFINED,
+  ERR_IR_ILL_NT,
+  ERR_IR_NUM_ARG_EXPECTED,
+  ERR_IR_DIV_BY_ZERO,
+  ERR_IR_NOT_DEFINED_FOR_TYPE,
+  ERR_IR_NOT_DEFINED_FUNCTION,
+  ERR_IR_NOT_IMPLEMENTED,
+  ERR_IR_ALLOC_FAILED,
+  ERR_IR_AST_MEMORY_NOT_ENOUGH,
+  ERR_IR_SYM_MEMORY_NOT_ENOUGH,
+  ERR_IR_SYM_INVALID,
+  ERR_IR_RANGE_EMPTY,
+  ERR_IR_RANGE_TOO_LONG,
+  ERR_IR_ROOT_NOT_BRACKETED,
+  ERR_IR_NO_ALTERNATIVE,
+  ERR_IR_CALLS_TOO_DEEP,
+  ERR_API_DISABLED,
+  STACK_ERRS(),
+  TABLE_ERRS(),
+} ERR;
+
+static const char *err_stringify(ERR err) {
+  switch (err) {
+    STRINGIFY_CASE(ERR_NOERROR)
+    STRINGIFY_CASE(ERR_RD_READ_FAILED)
+    STRINGIFY_CASE(ERR_PR_GENERAL)
+    STRINGIFY_CASE(ERR_PR_PAREN_NOT_OPENED)
+    STRINGIFY_CASE(ERR_PR_PAREN_NOT_CLOSED)
+    STRINGIFY_CASE(ERR_PR_TOKEN_UNEXPECTED)
+    STRINGIFY_CASE(ERR_PR_MEMORY_NOT_ENOUGH)
+    STRINGIFY_CASE(ERR_PR_UNEXPECTED_EXPRESSION)
+    STRINGIFY_CASE(ERR_PR_ARGS_MISMATCH)
+    STRINGIFY_CASE(ERR_PR_PARAM_REPEATED)
+    STRINGIFY_CASE(ERR_PR_BUILTIN_REDEFINED)
+    STRINGIFY_CASE(ERR_IR_ILL_NT)
+    STRINGIFY_CASE(ERR_IR_NUM_ARG_EXPECTED)
+    STRINGIFY_CASE(ERR_IR_DIV_BY_ZERO)
+    STRINGIFY_CASE(ERR_IR_NOT_DEFINED_FOR_TYPE)
+    STRINGIFY_CASE(ERR_IR_NOT_DEFINED_FUNCTION)
+    STRINGIFY_CASE(ERR_IR_NOT_IMPLEMENTED)
+    STRINGIFY_CASE(ERR_IR_ALLOC_FAILED)
+    STRINGIFY_CASE(ERR_IR_AST_MEMORY_NOT_ENOUGH)
+    STRINGIFY_CASE(ERR_IR_SYM_MEMORY_NOT_ENOUGH)
+    STRINGIFY_CASE(ERR_IR_SYM_INVALID)
+    STRINGIFY_CASE(ERR_IR_RANGE_EMPTY)
+    STRINGIFY_CASE(ERR_IR_RANGE_TOO_LONG)
+    STRINGIFY_CASE(ERR_IR_ROOT_NOT_BRACKETED)
+    STRINGIFY_CASE(ERR_IR_NO_ALTERNATIVE)
+    STRINGIFY_CASE(ERR_IR_CALLS_TOO_DEEP)
+    STRINGIFY_CASE(ERR_API_DISABLED)
+    STRINGIFY_CASE_STACK_ERRS()
+    STRINGIFY_CASE_TABLE_ERRS()    
+  }
+
+  return STRINGIFY(INVALID_ERR);
+}
+
+//=:parser:parser
+
+// resume points of a parser frame;
+typedef enum {
+  PS_LHS,
+  PS_UNOP,
+  PS_PAREN,
+  PS_ABS,
+  PS_OP,
+  PS_RHS,
+} Parser_State;
+
+// Parser_Frame - parses operand at lhs followed by operators of priorities
+// in [min, max]. Replaces a C stack frame of the recursive descent, so depth
+// of nesting is limited only by memory;
+typedef struct {
+  Node_Index lhs;
+  Node_Index rhs;
+  Node_Index rhs_lower;
+  Node_Pos op_pos;
+  Token_Type op_tt;
+  Priority min;
+  Priority max;
+  Parser_State state;
+  bool unary;
+} Parser_Frame;
+
+// Definition - nodes of definition of a user function, as f(x) = x^2 is,
+// children are indexed from its first node;
+typedef struct {
+  sym_t sym;
+  Node_Index len;
+  Node *nodes;
+} Definition;
+
+typedef struct {
+  Lexer lx;
+
+  ssize_t p0c;
+  bool abs;
+
+  Parser_Frame *frames;
+  size_t frames_len;
+  size_t frames_cap;
+
+  // source positions of nodes, recorded only when not NULL;
+  Node_Pos *nodes_pos;
+
+  Node_Index nodes_len;
+  Node_Index nodes_cap;
+
+  // buffer of nodes, compiled program takes it over;
+  Node *nodes;
+
+  // definitions of functions made by compiled programs, later programs
+  // calling them get their nodes;
+  Definition *defs;
+  Node_Index defs_len;
+  Node_Index defs_cap;
+} Parser;
+
+static ERR pr_nd_alloc(Parser *pr, Node_Index ptr[static 1]) {
+  if (pr->nodes_len + 1 >= pr->nodes_cap)
+    return ERR_PR_MEMORY_NOT_ENOUGH;
+
+  ptr[0] = pr->nodes_len;
+  ++pr->nodes_len;
+  return ERR_NOERROR;
+}
+
+static void pr_nd_mark(Parser *pr, Node_Index node, Node_Pos pos) {
+  if (pr->nodes_pos != NULL)
+    pr->nodes_pos[node] = pos;
+}
+
+static Node_Pos pr_pos(Parser *pr) {
+  return (Node_Pos){pr->lx.row, pr->lx.col};
+}
+
+static ERR pr_frame_push(Parser *pr, Node_Index node, Priority min, bool unary) {
+  if (pr->frames_len == pr->frames_cap) {
+    size_t cap = pr->frames_cap == 0 ? PARSER_FRAMES_CAPACITY
+                                     : pr->frames_cap * 2;
+    Parser_Frame *frames = realloc(pr->frames, cap * sizeof(Parser_Frame));
+    if (frames == NULL)
+      return ERR_PR_MEMORY_NOT_ENOUGH;
+    STATS_ALLOC(pr->lx.rd.stats, (cap - pr->frames_cap) * sizeof(Parser_Frame));
+
+    pr->frames = frames;
+    pr->frames_cap = cap;
+  }
+
+  pr->frames[pr->frames_len] = (Parser_Frame){
+      .lhs = node,
+      .min = min,
+      .max = PT_CAL_APX,
+      .state = PS_LHS,
+      .unary = unary,
+  };
+  ++pr->frames_len;
+  return ERR_NOERROR;
+}
+
+// pr_next_prim_node - parses primary or opens group at lhs of top frame;
+static ERR pr_next_prim_node(Parser *pr) {
+  Parser_Frame *f = &pr->frames[pr->frames_len - 1];
+  Node *node = &pr->nodes[f->lhs];
+
+  switch (pr->lx.tt) {
+  case TT_SYM:
+    node->type = NT_PRIM_SYM;
+    node->as.pm.s = pr->lx.pm.s;
+    lx_next_token(&pr->lx);
+    f->state = PS_OP;
+    break;
+  case TT_CMX:
+    node->type = NT_PRIM_CMX;
+    node->as.pm.c = pr->lx.pm.c;
+    node->rel_err = pr->lx.rel_err;
+    lx_next_token(&pr->lx);
+    f->state = PS_OP;
+    break;
+  case TT_ABS:
+    if (pr->abs)
+      return ERR_PR_TOKEN_UNEXPECTED;
+    pr->abs = true;
+    node->type = NT_UNOP_ABS;
+    TRY(ERR, pr_nd_alloc(pr, &node->as.up.nhs));
+    lx_next_token(&pr->lx);
+    f->state = PS_ABS;
+    return pr_frame_push(pr, node->as.up.nhs, PT_XPC, true);
+  case TT_LP0:
+    ++pr->p0c;
+    lx_next_token(&pr->lx);
+    f->state = PS_PAREN;
+    return pr_frame_push(pr, f->lhs, PT_XPC, true);
+  default:
+    return ERR_PR_TOKEN_UNEXPECTED;
+  }
+
+  return ERR_NOERROR;
+}
+
+// pr_skip_rp0 - closes group opened by '(' or '|';
+static ERR pr_skip_rp0(Parser *pr) {
+  if (pr->lx.tt == TT_RP0) {
+    if (--pr->p0c < 0)
+      return ERR_PR_PAREN_NOT_OPENED;
+
+    lx_next_token(&pr->lx);
+  } else if (pr->lx.tt == TT_ABS) {
+    pr->abs = false;
+    lx_next_token(&pr->lx);
+  }
+
+  return ERR_NOERROR;
+}
+
+// pr_next_op - applies operator at current token to lhs of top frame, if
+// its priority is in [min, max], or finishes the frame otherwise.
+// Left associative operators parse rhs with priority above their own, right
+// associative ones - with their own. Postfix operator is applied only once.
+static ERR pr_next_op(Parser *pr, bool done[static 1]) {
+  Parser_Frame *f = &pr->frames[pr->frames_len - 1];
+  Priority pt = pt_of_tt(pr->lx.tt);
+
+  if (pt == PT_NONE || pt < f->min || pt > f->max) {
+    *done = true;
+    return ERR_NOERROR;
+  }
+
+  f->op_tt = pr->lx.tt;
+  f->op_pos = pr_pos(pr);
+
+  if (pt == PT_FAC) {
+    Node_Index op, rhs;
+    TRY(ERR, pr_nd_alloc(pr, &rhs));
+    TRY(ERR, pr_nd_alloc(pr, &op));
+
+    pr_nd_mark(pr, op, f->op_pos);
+    pr_nd_mark(pr, rhs, f->op_pos);
+    pr->nodes[op].type = NT_BIOP_FAC;
+    pr->nodes[op].as.bp.lhs = f->lhs;
+    pr->nodes[op].as.bp.rhs = rhs;
+    pr->nodes[op].as.bp.rhs_lower = rhs;
+    pr->nodes[op].as.bp.rhs_upper = rhs;
+    pr->nodes[rhs].type = NT_PRIM_CMX;
+    pr->nodes[rhs].as.pm.c = pr->lx.pm.c;
+    pr->nodes[rhs].rel_err = 0;
+
+    lx_next_token(&pr->lx);
+
+    f->lhs = op;
+    f->max = PT_FAC - 1;
+    return ERR_NOERROR;
+  }
+
+  TRY(ERR, pr_nd_alloc(pr, &f->rhs));
+  f->rhs_lower = f->rhs;
+
+  if (pr->lx.tt != TT_LP0)
+    lx_next_token(&pr->lx);
+
+  f->max = pt;
+  f->state = PS_RHS;
+  return pr_frame_push(pr, f->rhs, pt_rl_biop(pt) ? pt : pt + 1,
+                       pt != PT_CAL_APX);
+}
+
+// pr_next_biop_node - builds node of operator applied by pr_next_op, once
+// its rhs is parsed;
+static ERR pr_next_biop_node(Parser *pr, Parser_Frame f[static 1]) {
+  Node_Index op;
+  TRY(ERR, pr_nd_alloc(pr, &op));
+
+  pr_nd_mark(pr, op, f->op_pos);
+  pr->nodes[op].type = tt_to_biop_nd(f->op_tt);
+  pr->nodes[op].as.bp.lhs = f->lhs;
+  pr->nodes[op].as.bp.rhs = f->rhs;
+  pr->nodes[op].as.bp.rhs_lower = f->rhs_lower;
+  pr->nodes[op].as.bp.rhs_upper = op - 1;
+
+  f->lhs = op;
+  f->state = PS_OP;
+  return ERR_NOERROR;
+}
+
+// pr_next_node - parses expression into node. Operands are parsed in
+// explicit frames instead of recursion: every frame in PS_LHS parses its
+// operand and, when it finishes, its lhs is returned to a frame below;
+static ERR pr_next_node(Parser *pr, Node_Index *node) {
+  lx_next_token(&pr->lx);
+
+  pr->frames_len = 0;
+  TRY(ERR, pr_frame_push(pr, *node, PT_XPC, true));
+
+  Node_Index ret = *node;
+  bool done;
+
+  for (;;) {
+    Parser_Frame *f = &pr->frames[pr->frames_len - 1];
+
+    switch (f->state) {
+    case PS_LHS:
+      pr_nd_mark(pr, f->lhs, pr_pos(pr));
+
+      if (f->unary && tt_is_unop(pr->lx.tt)) {
+        Node *unop = &pr->nodes[f->lhs];
+        unop->type = NT_UNOP_NOT * (pr->lx.tt == TT_NOT) +
+                     NT_UNOP_NEG * (pr->lx.tt == TT_NEG) +
+                     NT_UNOP_NOP * (pr->lx.tt == TT_NOP);
+
+        TRY(ERR, pr_nd_alloc(pr, &unop->as.up.nhs));
+
+        lx_next_token(&pr->lx);
+
+        f->max = PT_MUL_QUO_MOD;
+        f->state = PS_UNOP;
+        TRY(ERR, pr_frame_push(pr, unop->as.up.nhs, PT_POW, false));
+        continue;
+      }
+
+      TRY(ERR, pr_next_prim_node(pr));
+      continue;
+    case PS_UNOP:
+      pr->nodes[f->lhs].as.up.nhs = ret;
+      f->state = PS_OP;
+      continue;
+    case PS_PAREN:
+      TRY(ERR, pr_skip_rp0(pr));
+      f->lhs = ret;
+      f->state = PS_OP;
+      continue;
+    case PS_ABS:
+      TRY(ERR, pr_skip_rp0(pr));
+      pr->nodes[f->lhs].as.up.nhs = ret;
+      f->state = PS_OP;
+      continue;
+    case PS_OP:
+      done = false;
+      TRY(ERR, pr_next_op(pr, &done));
+      if (!done)
+        continue;
+
+      ret = f->lhs;
+      if (--pr->frames_len == 0)
+        break;
+      continue;
+    case PS_RHS:
+      f->rhs = ret;
+      TRY(ERR, pr_next_biop_node(pr, f));
+      continue;
+    }
+
+    break;
+  }
+
+  *node = ret;
+
+  if (pr->p0c != 0)
+    return ERR_PR_PAREN_NOT_CLOSED;
+
+  return ERR_NOERROR;
+}
+
+// pr_next_node_instrumented - same as pr_next_node, but accounts statistics;
+static ERR pr_next_node_instrumented(Parser *pr, Node_Index *node) {
+  [[maybe_unused]] Stats *stats = pr->lx.rd.stats;
+
+  STATS_CLOCK_BEGIN(stats, wall, CLOCK_MONOTONIC);
+  STATS_CLOCK_BEGIN(stats, cpu, CLOCK_PROCESS_CPUTIME_ID);
+  ERR err = pr_next_node(pr, node);
+  STATS_CLOCK_END(stats, cpu, CLOCK_PROCESS_CPUTIME_ID, front_cpu_ns);
+  STATS_CLOCK_END(stats, wall, CLOCK_MONOTONIC, wall_ns[SP_PARSE]);
+  STATS_ADD(stats, nodes, pr->nodes_len);
+  PROBE2(parse__done, err, pr->nodes_len);
+  return err;
+}
+
+//=:parser:unops
+
+// pr_postfix_unops - moves unary operators behind their operands. Parser
+// allocates unary operator before its operand, so program would need to look
+// ahead for the operand; after the move every node follows its operands;
+static ERR pr_postfix_unops(Parser *pr, Node_Index root[static 1]) {
+  Node_Index len = pr->nodes_len, pending_len = 0, n = 0;
+
+  bool any = false;
+  for (Node_Index i = 0; i < len && !any; ++i)
+    any = is_unop(pr->nodes[i].type);
+  if (!any)
+    return ERR_NOERROR;
+
+  // last[i] - last node of subtree of i, first[i] - first node at or after i
+  // which is not a unary operator, moved[i] - new index of i;
+  Node_Index *last = malloc(len * sizeof(Node_Index));
+  Node_Index *first = malloc(len * sizeof(Node_Index));
+  Node_Index *moved = malloc(len * sizeof(Node_Index));
+  Node_Index *pending = malloc(len * sizeof(Node_Index));
+  Node *nodes = malloc(len * sizeof(Node));
+  Node_Pos *pos = pr->nodes_pos != NULL ? malloc(len * sizeof(Node_Pos)) : NULL;
+
+  ERR err = ERR_NOERROR;
+  if (last == NULL || first == NULL || moved == NULL || pending == NULL ||
+      nodes == NULL || (pr->nodes_pos != NULL && pos == NULL)) {
+    err = ERR_PR_MEMORY_NOT_ENOUGH;
+    goto final;
+  }
+
+  for (Node_Index i = len; i-- > 0;) {
+    bool unop = is_unop(pr->nodes[i].type);
+    last[i] = unop ? last[pr->nodes[i].as.up.nhs] : i;
+    first[i] = unop ? first[i + 1] : i;
+  }
+
+  for (Node_Index i = 0; i < len; ++i) {
+    if (is_unop(pr->nodes[i].type)) {
+      pending[pending_len++] = i;
+      continue;
+    }
+
+    moved[i] = n++;
+    while (pending_len != 0 && last[pending[pending_len - 1]] == i)
+      moved[pending[--pending_len]] = n++;
+  }
+
+  memcpy(nodes, pr->nodes, len * sizeof(Node));
+  if (pos != NULL)
+    memcpy(pos, pr->nodes_pos, len * sizeof(Node_Pos));
+
+  for (Node_Index i = 0; i < len; ++i) {
+    Node *node = &pr->nodes[moved[i]];
+    *node = nodes[i];
+    if (pos != NULL)
+      pr->nodes_pos[moved[i]] = pos[i];
+
+    if (is_unop(node->type)) {
+      node->as.up.nhs = moved[node->as.up.nhs];
+    } else if (node->type > NT_PRIM_PRB) {
+      Bi_Op *bp = &node->as.bp;
+      // subtrees stay contiguous, they start at their first operand;
+      Node_Index rhs_len = bp->rhs_upper - bp->rhs_lower;
+      bp->lhs = moved[bp->lhs];
+      bp->rhs = moved[bp->rhs];
+      bp->rhs_lower = moved[first[bp->rhs_lower]];
+      bp->rhs_upper = bp->rhs_lower + rhs_len;
+    }
+  }
+
+  *root = moved[*root];
+
+final:
+  free(last);
+  free(first);
+  free(moved);
+  free(pending);
+  free(nodes);
+  free(pos);
+  return err;
+}
+
+//=:parser:reductions
+
+// reductions take (variable, from, to, body), body is evaluated by them for
+// every integer of [from, to]. Solving and integration take the same
+// arguments and evaluate body at points of [from, to] they choose;
+static inline bool is_reduction(sym_t fn) {
+  return fn == BUILTIN_SUM || fn == BUILTIN_PROD || fn == BUILTIN_MIN ||
+         fn == BUILTIN_MAX || fn == BUILTIN_SOLVE || fn == BUILTIN_INTEGRATE;
+}
+
+// pr_nd_is_reduction - reports whether call node applies a reduction;
+static bool pr_nd_is_reduction(const Node nodes[static 1], Node_Index call) {
+  const Node *fn = &nodes[nodes[call].as.bp.lhs];
+  return fn->type == NT_PRIM_SYM && is_reduction(fn->as.pm.s);
+}
+
+// pr_nd_reduction_args - reports whether reduction takes four arguments, the
+// first of which is a symbol;
+static bool pr_nd_reduction_args(const Node nodes[static 1], Node_Index call) {
+  Node_Index args = nodes[call].as.bp.rhs;
+  for (int i = 0; i < 3; ++i) {
+    if (nodes[args].type != NT_BIOP_SEP)
+      return false;
+    args = nodes[args].as.bp.lhs;
+  }
+
+  return nodes[args].type == NT_PRIM_SYM;
+}
+
+// nd_moved - returns new index of node after nodes [lower, upper] are moved
+// behind the other len nodes;
+static inline Node_Index nd_moved(Node_Index node, Node_Index lower,
+                                  Node_Index upper, Node_Index len) {
+  if (node < lower)
+    return node;
+  if (node > upper)
+    return node - (upper - lower + 1);
+  return node - lower + len - (upper - lower + 1);
+}
+
+// pr_nd_move_back - moves nodes [lower, upper] behind the other nodes and
+// renumbers references to moved nodes;
+static ERR pr_nd_move_back(Parser *pr, Node_Index lower, Node_Index upper,
+                    Node_Index root[static 1]) {
+  Node_Index len = pr->nodes_len, n = upper - lower + 1;
+
+  Node *moved = malloc(n * sizeof(Node));
+  if (moved == NULL)
+    return ERR_PR_MEMORY_NOT_ENOUGH;
+
+  memcpy(moved, &pr->nodes[lower], n * sizeof(Node));
+  memmove(&pr->nodes[lower], &pr->nodes[upper + 1],
+      (len - upper - 1) * sizeof(Node));
+  memcpy(&pr->nodes[len - n], moved, n * sizeof(Node));
+  free(moved);
+
+  if (pr->nodes_pos != NULL) {
+    Node_Pos *moved_pos = malloc(n * sizeof(Node_Pos));
+    if (moved_pos == NULL)
+      return ERR_PR_MEMORY_NOT_ENOUGH;
+
+    memcpy(moved_pos, &pr->nodes_pos[lower], n * sizeof(Node_Pos));
+    memmove(&pr->nodes_pos[lower], &pr->nodes_pos[upper + 1],
+        (len - upper - 1) * sizeof(Node_Pos));
+    memcpy(&pr->nodes_pos[len - n], moved_pos, n * sizeof(Node_Pos));
+    free(moved_pos);
+  }
+
+  for (Node_Index i = 0; i < len; ++i) {
+    Node *node = &pr->nodes[i];
+
+    if (is_unop(node->type)) {
+      node->as.up.nhs = nd_moved(node->as.up.nhs, lower, upper, len);
+    } else if (node->type > NT_PRIM_PRB) {
+      node->as.bp.lhs = nd_moved(node->as.bp.lhs, lower, upper, len);
+      node->as.bp.rhs = nd_moved(node->as.bp.rhs, lower, upper, len);
+      node->as.bp.rhs_lower = nd_moved(node->as.bp.rhs_lower, lower, upper, len);
+      node->as.bp.rhs_upper = nd_moved(node->as.bp.rhs_upper, lower, upper, len);
+    }
+  }
+
+  *root = nd_moved(*root, lower, upper, len);
+  return ERR_NOERROR;
+}
+
+// pr_lower_reductions - moves bodies of reductions behind the nodes executed
+// by program, so they are evaluated only by their reductions. Inner
+// reductions precede outer ones, so bodies are moved innermost first and
+// every body stays contiguous;
+static ERR pr_lower_reductions(Parser *pr, Node_Index root[static 1],
+                        Node_Index exec_len[static 1]) {
+  Node_Index end = pr->nodes_len;
+
+  for (Node_Index i = 0; i < end; ++i) {
+    if (pr->nodes[i].type != NT_CALL || !pr_nd_is_reduction(pr->nodes, i))
+      continue;
+
+    // variable, bounds and body;
+    if (!pr_nd_reduction_args(pr->nodes, i))
+      return ERR_PR_ARGS_MISMATCH;
+
+    Bi_Op body = pr->nodes[pr->nodes[i].as.bp.rhs].as.bp;
+    Node_Index n = body.rhs_upper - body.rhs_lower + 1;
+    TRY(ERR, pr_nd_move_back(pr, body.rhs_lower, body.rhs_upper, root));
+
+    i -= n;
+    end -= n;
+    pr->nodes[i].type = NT_REDUCE;
+  }
+
+  *exec_len = end;
+  return ERR_NOERROR;
+}
+
+//=:parser:slots
+
+#define G_TYPE Slot
+#include "generics/table.h"
+
+// symbols of called functions are not variables;
+#define SLOT_NONE (UINT32_MAX)
+
+// pr_resolve_slots - numbers variables of program by slots and writes slots
+// into their symbol nodes, so they are read by index instead of looking
+// global scope up. Assigned variables take the first *slots_stored slots,
+// only they are stored back to global scope after execution. params slots of
+// parameters bound by pr_bind_params follow slots of variables;
+static ERR pr_resolve_slots(Parser *pr, Slot params, sym_t *slot_syms[static 1],
+                     Slot slots_len[static 1], Slot slots_stored[static 1]) {
+  Node *nodes = pr->nodes;
+  size_t syms = 0;
+
+  for (Node_Index i = 0; i < pr->nodes_len; ++i) {
+    if (nodes[i].type == NT_PRIM_SYM && nodes[i].as.pm.s != 0) {
+      nodes[i].as.pm.slot = 0;
+      ++syms;
+    } else if ((nodes[i].type == NT_CALL || nodes[i].type == NT_REDUCE ||
+                nodes[i].type == NT_APPLY) &&
+               nodes[nodes[i].as.bp.lhs].type == NT_PRIM_SYM) {
+      nodes[nodes[i].as.bp.lhs].as.pm.slot = SLOT_NONE;
+    }
+  }
+
+  *slot_syms = NULL;
+  *slots_len = params;
+  *slots_stored = 0;
+  if (syms == 0)
+    return ERR_NOERROR;
+
+  // capacity is odd, so it is not 2^n;
+  size_t cap = syms * 2 + 1;
+  Map_Entry_Slot *slots = calloc(cap, sizeof(Map_Entry_Slot));
+  sym_t *names = malloc(syms * sizeof(sym_t));
+  if (slots == NULL || names == NULL) {
+    free(slots);
+    free(names);
+    return ERR_IR_ALLOC_FAILED;
+  }
+
+  Slot len = 0, slot;
+
+  for (Node_Index i = 0; i < pr->nodes_len; ++i) {
+    if (nodes[i].type != NT_BIOP_LET)
+      continue;
+
+    Node *lhs = &nodes[nodes[i].as.bp.lhs];
+    if (lhs->type == NT_PRIM_SYM && lhs->as.pm.s != 0 && map_get_Slot(slots, cap, lhs->as.pm.s, &slot) != ERR_NOERROR) {
+      map_set_Slot(slots, cap, lhs->as.pm.s, len);
+      names[len++] = lhs->as.pm.s;
+    }
+  }
+
+  *slots_stored = len;
+
+  for (Node_Index i = 0; i < pr->nodes_len; ++i) {
+    if (nodes[i].type != NT_PRIM_SYM || nodes[i].as.pm.slot == SLOT_NONE)
+      continue;
+
+    if (nodes[i].as.pm.s == 0) {
+      nodes[i].as.pm.slot += len;
+      continue;
+    }
+
+    if (map_get_Slot(slots, cap, nodes[i].as.pm.s, &slot) != ERR_NOERROR) {
+      slot = len;
+      map_set_Slot(slots, cap, nodes[i].as.pm.s, slot);
+      names[len++] = nodes[i].as.pm.s;
+    }
+
+    nodes[i].as.pm.slot = slot;
+  }
+
+  free(slots);
+  *slot_syms = names;
+  *slots_len = len + params;
+  return ERR_NOERROR;
+}
+
+//=:parser:functions
+
+// user functions are defined as f(x, y) = body and called as f(1, 2). Their
+// parameters are read from slots of their own, which a call binds to its
+// arguments and restores after the body. Definitions are kept by parser, so
+// programs call functions defined by the earlier ones;
+
+static bool ir_nd_yields(const Node nodes[static 1], Node_Index node);
+
+// nd_args_len - returns number of arguments of call node;
+static inline uint32_t nd_args_len(const Node *nodes, Node_Index call) {
+  uint32_t len = 1;
+  for (Node_Index args = nodes[call].as.bp.rhs;
+       nodes[args].type == NT_BIOP_SEP; args = nodes[args].as.bp.lhs)
+    ++len;
+
+  return len;
+}
+
+// pr_nd_has_head - reports whether node assigns a value to a call of a
+// symbol by symbols, its head. The first node of head is the first one of
+// node;
+static bool pr_nd_has_head(const Node *nodes, Node_Index let) {
+  if (nodes[let].type != NT_BIOP_LET)
+    return false;
+
+  Node_Index head = nodes[let].as.bp.lhs;
+  if (nodes[head].type != NT_CALL ||
+      nodes[nodes[head].as.bp.lhs].type != NT_PRIM_SYM)
+    return false;
+
+  Node_Index args = nodes[head].as.bp.rhs;
+  for (; nodes[args].type == NT_BIOP_SEP; args = nodes[args].as.bp.lhs)
+    if (nodes[nodes[args].as.bp.rhs].type != NT_PRIM_SYM)
+      return false;
+
+  return nodes[args].type == NT_PRIM_SYM &&
+         ir_nd_yields(nodes, nodes[let].as.bp.rhs);
+}
+
+// pr_nd_is_definition - reports whether node has a head of other than
+// builtin symbol, so it defines a function;
+static bool pr_nd_is_definition(const Node *nodes, Node_Index let) {
+  return pr_nd_has_head(nodes, let) &&
+         nodes[nodes[nodes[let].as.bp.lhs].as.bp.lhs].as.pm.s >= BUILTIN_COUNT;
+}
+
+// pr_nd_check_definition - returns ERR_PR_BUILTIN_REDEFINED if node has a
+// head of builtin symbol, or ERR_PR_PARAM_REPEATED if a parameter of its head
+// is named twice;
+static ERR pr_nd_check_definition(const Node *nodes, Node_Index let) {
+  if (!pr_nd_has_head(nodes, let))
+    return ERR_NOERROR;
+
+  Node_Index head = nodes[let].as.bp.lhs;
+  if (nodes[nodes[head].as.bp.lhs].as.pm.s < BUILTIN_COUNT)
+    return ERR_PR_BUILTIN_REDEFINED;
+
+  // parameters are compared with the ones before them, from the last one;
+  for (Node_Index args = nodes[head].as.bp.rhs;
+       nodes[args].type == NT_BIOP_SEP; args = nodes[args].as.bp.lhs) {
+    sym_t param = nodes[nodes[args].as.bp.rhs].as.pm.s;
+
+    Node_Index prev = nodes[args].as.bp.lhs;
+    for (; nodes[prev].type == NT_BIOP_SEP; prev = nodes[prev].as.bp.lhs)
+      if (nodes[nodes[prev].as.bp.rhs].as.pm.s == param)
+        return ERR_PR_PARAM_REPEATED;
+
+    if (nodes[prev].as.pm.s == param)
+      return ERR_PR_PARAM_REPEATED;
+  }
+
+  return ERR_NOERROR;
+}
+
+// pr_nd_shift - renumbers children of node moved by to - from;
+static inline void pr_nd_shift(Node nd[static 1], Node_Index from,
+                               Node_Index to) {
+  if (is_unop(nd->type)) {
+    nd->as.up.nhs = nd->as.up.nhs - from + to;
+  } else if (nd->type > NT_PRIM_PRB) {
+    nd->as.bp.lhs = nd->as.bp.lhs - from + to;
+    nd->as.bp.rhs = nd->as.bp.rhs - from + to;
+    nd->as.bp.rhs_lower = nd->as.bp.rhs_lower - from + to;
+    nd->as.bp.rhs_upper = nd->as.bp.rhs_upper - from + to;
+  }
+}
+
+// def_find - returns index of definition of sym among defs or len;
+static inline Node_Index def_find(const Definition *defs, Node_Index len,
+                                  sym_t sym) {
+  Node_Index i = 0;
+  while (i < len && defs[i].sym != sym)
+    ++i;
+
+  return i;
+}
+
+static void defs_free(Definition *defs, Node_Index len) {
+  for (Node_Index i = 0; i < len; ++i)
+    free(defs[i].nodes);
+  free(defs);
+}
+
+// pr_link_functions - sets *defs_out to copies of definitions of program and
+// puts kept definitions of functions called by program, but not defined by
+// it, before it. They are executed by a chain of sequences ending with
+// program, so it stays a single tree rooted at *root;
+static ERR pr_link_functions(Parser *pr, Node_Index root[static 1],
+                      Definition *defs_out[static 1],
+                      Node_Index defs_len[static 1]) {
+  Node_Index len = pr->nodes_len, n = 0;
+
+  *defs_out = NULL;
+  *defs_len = 0;
+
+  for (Node_Index i = 1; i < len; ++i) {
+    TRY(ERR, pr_nd_check_definition(pr->nodes, i));
+    n += pr_nd_is_definition(pr->nodes, i);
+  }
+  if (n == 0 && pr->defs_len == 0)
+    return ERR_NOERROR;
+
+  Definition *defs = calloc(n + 1, sizeof(Definition));
+  Node_Index *linked = malloc((pr->defs_len + 1) * sizeof(Node_Index));
+  bool *included = calloc(pr->defs_len + 1, sizeof(bool));
+
+  ERR err = ERR_NOERROR;
+  if (defs == NULL || linked == NULL || included == NULL) {
+    err = ERR_PR_MEMORY_NOT_ENOUGH;
+    goto final;
+  }
+
+  n = 0;
+  for (Node_Index i = 1; i < len; ++i) {
+    if (!pr_nd_is_definition(pr->nodes, i))
+      continue;
+
+    Node_Index head = pr->nodes[i].as.bp.lhs, begin = pr->nodes[head].as.bp.lhs;
+    Definition *def = &defs[n++];
+    def->sym = pr->nodes[begin].as.pm.s;
+    def->len = i - begin + 1;
+    def->nodes = malloc(def->len * sizeof(Node));
+    if (def->nodes == NULL) {
+      err = ERR_PR_MEMORY_NOT_ENOUGH;
+      goto final;
+    }
+
+    for (Node_Index j = 0; j < def->len; ++j) {
+      def->nodes[j] = pr->nodes[begin + j];
+      pr_nd_shift(&def->nodes[j], begin, 0);
+    }
+  }
+
+  // included definitions are scanned for calls too, every one is included
+  // once;
+  Node_Index linked_len = 0;
+  for (Node_Index i = 0; i < pr->nodes_len && pr->defs_len != 0; ++i) {
+    if (pr->nodes[i].type != NT_CALL)
+      continue;
+
+    const Node *fn = &pr->nodes[pr->nodes[i].as.bp.lhs];
+    if (fn->type != NT_PRIM_SYM || def_find(defs, n, fn->as.pm.s) != n)
+      continue;
+
+    Node_Index d = def_find(pr->defs, pr->defs_len, fn->as.pm.s);
+    if (d == pr->defs_len || included[d])
+      continue;
+
+    // every definition takes a sequence, which chains it;
+    const Definition *def = &pr->defs[d];
+    if (pr->nodes_len + def->len + linked_len + 1 >= pr->nodes_cap) {
+      err = ERR_PR_MEMORY_NOT_ENOUGH;
+      goto final;
+    }
+
+    for (Node_Index j = 0; j < def->len; ++j) {
+      pr->nodes[pr->nodes_len + j] = def->nodes[j];
+      pr_nd_shift(&pr->nodes[pr->nodes_len + j], 0, pr->nodes_len);
+      if (pr->nodes_pos != NULL)
+        pr->nodes_pos[pr->nodes_len + j] = (Node_Pos){0};
+    }
+
+    included[d] = true;
+    linked[linked_len++] = pr->nodes_len;
+    pr->nodes_len += def->len;
+  }
+
+  if (linked_len == 0)
+    goto final;
+
+  err = pr_nd_move_back(pr, 0, len - 1, root);
+  if (err != ERR_NOERROR)
+    goto final;
+
+  // definitions are followed by program now, sequence of definition j is
+  // rooted at its assignment and the rest follows it;
+  Node_Index rest = pr->nodes_len - len;
+  for (Node_Index j = linked_len; j-- > 0;) {
+    Node_Index xpc = pr->nodes_len++, begin = linked[j] - len;
+
+    pr->nodes[xpc] = (Node){
+        .type = NT_BIOP_XPC,
+        .as.bp = {
+            .lhs = rest - 1,
+            .rhs = *root,
+            .rhs_lower = rest,
+            .rhs_upper = xpc - 1,
+        },
+    };
+    if (pr->nodes_pos != NULL)
+      pr->nodes_pos[xpc] = (Node_Pos){0};
+
+    *root = xpc;
+    rest = begin;
+  }
+
+final:
+  if (err != ERR_NOERROR || n == 0) {
+    defs_free(defs, n);
+    defs = NULL;
+    n = 0;
+  }
+
+  free(linked);
+  free(included);
+  *defs_out = defs;
+  *defs_len = n;
+  return err;
+}
+
+// pr_keep_definitions - takes definitions over, they replace kept ones of the
+// same functions;
+static ERR pr_keep_definitions(Parser *pr, Definition *defs, Node_Index len) {
+  ERR err = ERR_NOERROR;
+  Node_Index i = 0;
+
+  for (; i < len; ++i) {
+    Node_Index d = def_find(pr->defs, pr->defs_len, defs[i].sym);
+
+    if (d == pr->defs_len && pr->defs_len == pr->defs_cap) {
+      Node_Index cap = pr->defs_cap == 0 ? 8 : pr->defs_cap * 2;
+      Definition *grown = realloc(pr->defs, cap * sizeof(Definition));
+      if (grown == NULL) {
+        err = ERR_PR_MEMORY_NOT_ENOUGH;
+        break;
+      }
+      STATS_ALLOC(pr->lx.rd.stats, (cap - pr->defs_cap) * sizeof(Definition));
+
+      pr->defs = grown;
+      pr->defs_cap = cap;
+    }
+
+    if (d == pr->defs_len)
+      ++pr->defs_len;
+    else
+      free(pr->defs[d].nodes);
+
+    STATS_ALLOC(pr->lx.rd.stats, defs[i].len * sizeof(Node));
+    pr->defs[d] = defs[i];
+  }
+
+  for (; i < len; ++i)
+    free(defs[i].nodes);
+  free(defs);
+  return err;
+}
+
+// pr_lower_functions - moves definitions behind the nodes executed by
+// program in their order, they become NT_DEFINE, which is never executed.
+// Calls of defined functions become NT_APPLY, a call is of the last
+// definition of its function;
+static ERR pr_lower_functions(Parser *pr, Node_Index root[static 1],
+                       Node_Index exec_len[static 1]) {
+  Node_Index n = 0;
+
+  // nodes after a moved definition take its place, so they are looked at
+  // from its first node on;
+  for (Node_Index i = 1; i < *exec_len;) {
+    if (!pr_nd_is_definition(pr->nodes, i)) {
+      ++i;
+      continue;
+    }
+
+    Node_Index begin = pr->nodes[pr->nodes[i].as.bp.lhs].as.bp.lhs;
+    TRY(ERR, pr_nd_move_back(pr, begin, i, root));
+
+    *exec_len -= i - begin + 1;
+    pr->nodes[pr->nodes_len - 1].type = NT_DEFINE;
+    i = begin;
+    ++n;
+  }
+
+  if (n == 0)
+    return ERR_NOERROR;
+
+  Node_Index *defs = malloc(n * sizeof(Node_Index));
+  if (defs == NULL)
+    return ERR_PR_MEMORY_NOT_ENOUGH;
+
+  n = 0;
+  for (Node_Index i = *exec_len; i < pr->nodes_len; ++i)
+    if (pr->nodes[i].type == NT_DEFINE)
+      defs[n++] = i;
+
+  Node *nodes = pr->nodes;
+  for (Node_Index i = 1; i < pr->nodes_len; ++i) {
+    if (nodes[i].type != NT_CALL ||
+        nodes[nodes[i].as.bp.lhs].type != NT_PRIM_SYM)
+      continue;
+
+    // heads of definitions are not calls;
+    sym_t sym = nodes[nodes[i].as.bp.lhs].as.pm.s;
+    Node_Index def = 0;
+    for (Node_Index j = n; j-- > 0;) {
+      Node_Index head = nodes[defs[j]].as.bp.lhs;
+      if (head == i) {
+        def = 0;
+        break;
+      }
+
+      if (def == 0 && nodes[nodes[head].as.bp.lhs].as.pm.s == sym)
+        def = defs[j];
+    }
+
+    if (def == 0)
+      continue;
+
+    if (nd_args_len(nodes, i) != nd_args_len(nodes, nodes[def].as.bp.lhs)) {
+      free(defs);
+      return ERR_PR_ARGS_MISMATCH;
+    }
+
+    nodes[i].type = NT_APPLY;
+  }
+
+  free(defs);
+  return ERR_NOERROR;
+}
+
+// pr_bind_range - binds symbols of params read by nodes [lower, upper] and
+// bodies of reductions among them to slots of params from first. Called
+// symbols are not read, they get their symbols back;
+static void pr_bind_range(Node *nodes, Node_Index lower, Node_Index upper,
+                          const sym_t params[static 1], uint32_t len,
+                          Slot first) {
+  for (Node_Index i = lower; i <= upper; ++i) {
+    Node *nd = &nodes[i];
+
+    if (nd->type == NT_PRIM_SYM) {
+      for (uint32_t j = 0; j < len; ++j) {
+        if (nd->as.pm.s == params[j]) {
+          nd->as.pm = (Primitive){.s = 0, .slot = first + j};
+          break;
+        }
+      }
+    } else if (nd->type == NT_CALL || nd->type == NT_APPLY ||
+               nd->type == NT_REDUCE) {
+      Node *fn = &nodes[nd->as.bp.lhs];
+      if (fn->type == NT_PRIM_SYM && fn->as.pm.s == 0)
+        fn->as.pm.s = params[fn->as.pm.slot - first];
+
+      if (nd->type == NT_REDUCE) {
+        const Bi_Op *args = &nodes[nd->as.bp.rhs].as.bp;
+        pr_bind_range(nodes, args->rhs_lower, args->rhs_upper, params, len,
+            first);
+      }
+    }
+  }
+}
+
+// pr_bind_params - binds parameters of functions to consecutive slots of
+// each function, their symbol nodes take no symbol. Slots are numbered from 0
+// and *params_len of them are taken;
+static void pr_bind_params(Parser *pr, Node_Index exec_len,
+                    Slot params_len[static 1]) {
+  Node *nodes = pr->nodes;
+  *params_len = 0;
+
+  for (Node_Index i = exec_len; i < pr->nodes_len; ++i) {
+    if (nodes[i].type != NT_DEFINE)
+      continue;
+
+    Node_Index head = nodes[i].as.bp.lhs, args = nodes[head].as.bp.rhs;
+    uint32_t len = nd_args_len(nodes, head);
+
+    sym_t params[len];
+    for (uint32_t j = len - 1; j > 0; --j, args = nodes[args].as.bp.lhs)
+      params[j] = nodes[nodes[args].as.bp.rhs].as.pm.s;
+    params[0] = nodes[args].as.pm.s;
+
+    pr_bind_range(nodes, nodes[head].as.bp.rhs_lower,
+        nodes[head].as.bp.rhs_upper, params, len, *params_len);
+    pr_bind_range(nodes, nodes[i].as.bp.rhs_lower, nodes[i].as.bp.rhs_upper,
+        params, len, *params_len);
+    *params_len += len;
+  }
+}
+
+//=:parser:simplify
+
+// no node, kept node of targets and node, which is not a target of other
+// nodes, dropped by simplification;
+#define SIMPLIFY_NONE (UINT32_MAX - 1)
+#define SIMPLIFY_DROPPED (UINT32_MAX)
+
+// pr_nd_numeric - reports whether node surely leaves a number, so an operator,
+// which only checks type of its value, may be dropped behind it;
+static inline bool pr_nd_numeric(const Node *nodes, Node_Index node) {
+  Node_Type nt = nodes[node].type;
+  return nt == NT_PRIM_CMX || (nt >= NT_BIOP_ADD && nt <= NT_BIOP_POW) ||
+         nt == NT_BIOP_FAC || is_unop(nt) || nt == NT_CALL ||
+         nt == NT_REDUCE || nt == NT_POWI;
+}
+
+// pr_nd_real - reports whether node is a real literal, which is not
+// approximate when exact is set;
+static inline bool pr_nd_real(const Node *nodes, Node_Index node, bool exact) {
+  return nodes[node].type == NT_PRIM_CMX && cimag(nodes[node].as.pm.c) == 0 &&
+         (!exact || nodes[node].rel_err == 0);
+}
+
+// pr_nd_identity - reports whether node is exact literal of value v;
+static inline bool pr_nd_identity(const Node *nodes, Node_Index node, double v) {
+  return pr_nd_real(nodes, node, true) && creal(nodes[node].as.pm.c) == v;
+}
+
+// pr_nd_remap - sets children of node by new indices of nodes plus one;
+static inline void pr_nd_remap(Node nd[static 1],
+                               const Node_Index after[static 1]) {
+  if (is_unop(nd->type) || nd->type == NT_POWI) {
+    nd->as.up.nhs = after[nd->as.up.nhs] - 1;
+  } else if (nd->type == NT_POLY) {
+    nd->as.up.nhs = after[nd->as.up.nhs] - 1;
+    nd->as.up.poly.coefs = after[nd->as.up.poly.coefs] - 1;
+  } else if (nd->type > NT_PRIM_PRB) {
+    nd->as.bp.lhs = after[nd->as.bp.lhs] - 1;
+    nd->as.bp.rhs = after[nd->as.bp.rhs] - 1;
+    // rhs of a sequence after moved definitions may start at node 0;
+    nd->as.bp.rhs_lower =
+        nd->as.bp.rhs_lower != 0 ? after[nd->as.bp.rhs_lower - 1] : 0;
+    nd->as.bp.rhs_upper = after[nd->as.bp.rhs_upper] - 1;
+  }
+}
+
+// pr_simplify_to - returns node, which takes place of child;
+static inline Node_Index pr_simplify_to(const Node_Index *to, Node_Index child) {
+  return to != NULL && to[child] < SIMPLIFY_NONE ? to[child] : child;
+}
+
+// pr_simplify_rule - rewrites node by the first rule matching it, returns the
+// rule or SR_COUNT. Node replaced by its operand x sets *target to x, when x
+// is surely a number, and becomes NT_UNOP_NOP of x otherwise, so a value of
+// another type still fails. Literal or operator, which is left out by the
+// rule, is set to *dropped. Children of node are given by targets to;
+static inline Stats_Rule pr_simplify_rule(Node *nodes, Node_Index node,
+                                          const Node_Index *to,
+                                          Node_Index target[static 1],
+                                          Node_Index dropped[static 1]) {
+  Node *nd = &nodes[node];
+  Node_Index l, r, x;
+  Stats_Rule rule = SR_IDENTITY;
+
+  if (is_unop(nd->type)) {
+    l = pr_simplify_to(to, nd->as.up.nhs);
+    r = SIMPLIFY_NONE;
+  } else if (nd->type >= NT_BIOP_ADD && nd->type <= NT_BIOP_POW) {
+    l = pr_simplify_to(to, nd->as.bp.lhs);
+    r = pr_simplify_to(to, nd->as.bp.rhs);
+  } else {
+    return SR_COUNT;
+  }
+
+  switch (nd->type) {
+  case NT_UNOP_NOP:
+    // unary plus of a number;
+    if (!pr_nd_numeric(nodes, l))
+      return SR_COUNT;
+    *target = l;
+    return rule;
+  case NT_UNOP_NEG:
+    if (nodes[l].type != NT_UNOP_NEG)
+      return SR_COUNT;
+    x = pr_simplify_to(to, nodes[l].as.up.nhs);
+    *dropped = l;
+    rule = SR_NEGATION;
+    break;
+  case NT_BIOP_ADD:
+  case NT_BIOP_MUL: {
+    double v = nd->type == NT_BIOP_MUL;
+    if (pr_nd_identity(nodes, r, v))
+      x = l, *dropped = r;
+    else if (pr_nd_identity(nodes, l, v))
+      x = r, *dropped = l;
+    else
+      return SR_COUNT;
+    break;
+  }
+  case NT_BIOP_SUB:
+    if (!pr_nd_identity(nodes, r, 0))
+      return SR_COUNT;
+    x = l, *dropped = r;
+    break;
+  case NT_BIOP_QUO: {
+    if (pr_nd_identity(nodes, r, 1)) {
+      x = l, *dropped = r;
+      break;
+    }
+
+    if (!pr_nd_real(nodes, r, false))
+      return SR_COUNT;
+
+    // fma gives 1 - rc*c unrounded, which is 0 only when rc is exact, and
+    // x*rc is then rounded as x/c is. Other reciprocals would change
+    // results, 3/10 would not be 0.3;
+    double c = creal(nodes[r].as.pm.c), rc = 1 / c;
+    if (!isnormal(rc) || fma(-rc, c, 1) != 0)
+      return SR_COUNT;
+
+    nodes[r].as.pm.c = rc;
+    nd->type = NT_BIOP_MUL;
+    return SR_RECIPROCAL;
+  }
+  case NT_BIOP_POW: {
+    if (pr_nd_identity(nodes, r, 1)) {
+      x = l, *dropped = r;
+      break;
+    }
+
+    if (!pr_nd_real(nodes, r, true))
+      return SR_COUNT;
+
+    double n = creal(nodes[r].as.pm.c);
+    if (n < 2 || n > SIMPLIFY_POW_MAX || n != floor(n))
+      return SR_COUNT;
+
+    *nd = (Node){.type = NT_POWI, .as.up = {.nhs = l, .exp = (uint32_t)n}};
+    *dropped = r;
+    return SR_POWER;
+  }
+  default:
+    return SR_COUNT;
+  }
+
+  if (pr_nd_numeric(nodes, x))
+    *target = x;
+  else
+    *nd = (Node){.type = NT_UNOP_NOP, .as.up.nhs = x};
+
+  return rule;
+}
+
+// pr_simplify - rewrites operators of program to cheaper ones of the same
+// values and rel_err. Operators applied to their identities, as x*1, x+0,
+// x-0, x/1 and x^1 are, and --x are dropped, x/c becomes x*(1/c), when 1/c is
+// exact, and x^n of a small integer n becomes NT_POWI, which multiplies.
+// Fired rules are counted by statistics;
+static ERR pr_simplify(Parser *pr, Node_Index root[static 1],
+                Node_Index exec_len[static 1]) {
+  Node *nodes = pr->nodes;
+  Node_Index len = pr->nodes_len;
+
+  // rules rarely fire, so targets of dropped nodes, which are SIMPLIFY_NONE
+  // for the kept ones, are allocated by the first of them. Node 0 is a leaf
+  // of program, no rule rewrites it, but it may be dropped or be a target;
+  Node_Index *to = NULL;
+
+  for (Node_Index i = 0; i < len; ++i) {
+    Node_Index target = SIMPLIFY_NONE, dropped = SIMPLIFY_NONE;
+
+    Stats_Rule rule = pr_simplify_rule(nodes, i, to, &target, &dropped);
+    if (rule == SR_COUNT)
+      continue;
+    STATS_INC(pr->lx.rd.stats, rules[rule]);
+
+    if (to == NULL) {
+      if ((to = malloc(len * sizeof(Node_Index))) == NULL)
+        return ERR_PR_MEMORY_NOT_ENOUGH;
+      for (Node_Index j = 0; j < len; ++j)
+        to[j] = SIMPLIFY_NONE;
+    }
+
+    if (target != SIMPLIFY_NONE)
+      to[i] = target;
+    if (dropped != SIMPLIFY_NONE)
+      to[dropped] = SIMPLIFY_DROPPED;
+  }
+
+  if (to == NULL)
+    return ERR_NOERROR;
+
+  // targets are not needed anymore, they take new indices of nodes plus one.
+  // A dropped node is replaced by its target, which is the last node before
+  // it, and rhs_lower of a reduction is after the nodes dropped before it;
+  Node_Index *after = to, n = 0;
+  for (Node_Index i = 0; i < len; ++i) {
+    n += to[i] == SIMPLIFY_NONE;
+    after[i] = n;
+  }
+
+  for (Node_Index i = 0; i < len; ++i) {
+    if (after[i] == (i != 0 ? after[i - 1] : 0))
+      continue;
+
+    Node nd = nodes[i];
+    pr_nd_remap(&nd, after);
+    nodes[after[i] - 1] = nd;
+    if (pr->nodes_pos != NULL)
+      pr->nodes_pos[after[i] - 1] = pr->nodes_pos[i];
+  }
+
+  pr->nodes_len = n;
+  *root = after[*root] - 1;
+  *exec_len = *exec_len != 0 ? after[*exec_len - 1] : 0;
+
+  free(to);
+  return ERR_NOERROR;
+}
+
+//=:parser:polynomials
+
+// marks of nodes of polynomials: no node, which is not a polynomial or is
+// kept, a sum of constants only, which is of any variable, and a node
+// dropped by its polynomial;
+#define POLY_NONE (UINT32_MAX - 2)
+#define POLY_CONST (UINT32_MAX - 1)
+#define POLY_DROPPED (UINT32_MAX)
+
+// Poly_Term - node of a sum taken with its sign;
+typedef struct {
+  Node_Index node;
+  bool neg;
+} Poly_Term;
+
+// pr_nd_monomial - returns degree of term of a polynomial, which is a literal,
+// variable or a power of it, optionally multiplied by a literal, or -1. Sets
+// *coef to literal node, POLY_NONE for coefficient 1, and *var to node of
+// variable, POLY_NONE for a literal;
+static inline int pr_nd_monomial(const Node *nodes, Node_Index node,
+                                 Node_Index coef[static 1],
+                                 Node_Index var[static 1]) {
+  const Node *nd = &nodes[node];
+  *coef = POLY_NONE;
+  *var = POLY_NONE;
+
+  if (nd->type == NT_PRIM_CMX) {
+    *coef = node;
+    return 0;
+  }
+
+  if (nd->type == NT_BIOP_MUL) {
+    if (nodes[nd->as.bp.lhs].type == NT_PRIM_CMX)
+      *coef = nd->as.bp.lhs, nd = &nodes[nd->as.bp.rhs];
+    else if (nodes[nd->as.bp.rhs].type == NT_PRIM_CMX)
+      *coef = nd->as.bp.rhs, nd = &nodes[nd->as.bp.lhs];
+    else
+      return -1;
+  }
+
+  if (nd->type == NT_POWI && nodes[nd->as.up.nhs].type == NT_PRIM_SYM) {
+    *var = nd->as.up.nhs;
+    return nd->as.up.exp;
+  }
+
+  if (nd->type == NT_PRIM_SYM) {
+    *var = nd - nodes;
+    return 1;
+  }
+
+  return -1;
+}
+
+// pr_nd_poly_var - returns variable of polynomial of node given variables of
+// its children in vars, POLY_CONST or POLY_NONE, when node is not a
+// polynomial;
+static inline Node_Index pr_nd_poly_var(const Node *nodes, Node_Index node,
+                                        const Node_Index vars[static 1]) {
+  const Node *nd = &nodes[node];
+  Node_Index coef, var, l, r;
+
+  switch (nd->type) {
+  case NT_BIOP_ADD:
+  case NT_BIOP_SUB:
+    l = vars[nd->as.bp.lhs];
+    r = vars[nd->as.bp.rhs];
+    if (l == POLY_NONE || r == POLY_NONE)
+      return POLY_NONE;
+    if (l == POLY_CONST)
+      return r;
+    if (r == POLY_CONST || nodes[l].as.pm.s == nodes[r].as.pm.s)
+      return l;
+    return POLY_NONE;
+  case NT_UNOP_NEG:
+  case NT_UNOP_NOP:
+    return vars[nd->as.up.nhs];
+  default:
+    if (pr_nd_monomial(nodes, node, &coef, &var) < 0)
+      return POLY_NONE;
+    return var != POLY_NONE ? var : POLY_CONST;
+  }
+}
+
+// pr_collect_poly - sets coefficients of polynomial of sum at root by its
+// terms, from the highest degree, returns the degree or -1, when the
+// polynomial is not worth evaluating by Horner's rule. That is, when it is
+// of degree less than 2, some degree is taken by two terms, or coefficients
+// take more nodes than are dropped. Sets *first to the first node of sum;
+static inline int pr_collect_poly(const Node *nodes, Node_Index root,
+                                  Poly_Term stack[static 1],
+                                  Node coefs[static SIMPLIFY_POW_MAX + 1],
+                                  Node_Index first[static 1]) {
+  bool taken[SIMPLIFY_POW_MAX + 1] = {0};
+  Node_Index len = 1, coef, var;
+  int degree = 0;
+
+  stack[0] = (Poly_Term){root, false};
+  *first = root;
+
+  while (len != 0) {
+    Poly_Term t = stack[--len];
+    const Node *nd = &nodes[t.node];
+
+    switch (nd->type) {
+    case NT_BIOP_ADD:
+    case NT_BIOP_SUB:
+      stack[len++] = (Poly_Term){nd->as.bp.lhs, t.neg};
+      stack[len++] = (Poly_Term){nd->as.bp.rhs, t.neg ^ (nd->type == NT_BIOP_SUB)};
+      continue;
+    case NT_UNOP_NEG:
+    case NT_UNOP_NOP:
+      stack[len++] = (Poly_Term){nd->as.up.nhs, t.neg ^ (nd->type == NT_UNOP_NEG)};
+      continue;
+    default:
+      break;
+    }
+
+    int k = pr_nd_monomial(nodes, t.node, &coef, &var);
+    if (taken[k])
+      return -1;
+    taken[k] = true;
+    degree = MAX(degree, k);
+
+    coefs[k] = coef != POLY_NONE ? nodes[coef]
+                                 : (Node){.type = NT_PRIM_CMX, .as.pm.c = 1};
+    if (t.neg)
+      coefs[k].as.pm.c = -coefs[k].as.pm.c;
+
+    // POLY_NONE is above every node;
+    *first = MIN(*first, MIN(coef, var));
+  }
+
+  if (degree < 2 || (Node_Index)degree + 3 > root - *first + 1)
+    return -1;
+
+  // literals are in order of degrees, Horner's rule takes the highest first;
+  for (int k = 0; k <= degree; ++k) {
+    if (!taken[k])
+      coefs[k] = (Node){.type = NT_PRIM_CMX, .as.pm.c = 0};
+  }
+  for (int k = 0; k < degree - k; ++k) {
+    Node tmp = coefs[k];
+    coefs[k] = coefs[degree - k];
+    coefs[degree - k] = tmp;
+  }
+
+  return degree;
+}
+
+// pr_fold_polys - replaces sums of literals times powers of a variable by
+// NT_POLY of the variable, which evaluates polynomial by its coefficients.
+// Coefficients are literal nodes after the rest of program, dropped nodes of
+// sums leave room for them. Sums are only looked up, when powers are in
+// program, and sums, which are not folded, are not looked into;
+static ERR pr_fold_polys(Parser *pr, Node_Index root[static 1],
+                  Node_Index exec_len[static 1]) {
+  Node *nodes = pr->nodes;
+  Node_Index len = pr->nodes_len;
+
+  bool powers = false;
+  for (Node_Index i = 0; i < len && !powers; ++i)
+    powers = nodes[i].type == NT_POWI;
+  if (!powers)
+    return ERR_NOERROR;
+
+  Node_Index *vars = malloc(len * sizeof(Node_Index));
+  Poly_Term *stack = malloc(len * sizeof(Poly_Term));
+  Node *coefs = NULL;
+  Node_Index coefs_len = 0, coefs_cap = 0;
+
+  ERR err = ERR_NOERROR;
+  if (vars == NULL || stack == NULL) {
+    err = ERR_PR_MEMORY_NOT_ENOUGH;
+    goto final;
+  }
+
+  // variable or literal of the first node of program is a polynomial too;
+  for (Node_Index i = 0; i < len; ++i)
+    vars[i] = pr_nd_poly_var(nodes, i, vars);
+
+  for (Node_Index i = len; i-- > 0;) {
+    Node_Type nt = nodes[i].type;
+    if (vars[i] >= POLY_NONE ||
+        (nt != NT_BIOP_ADD && nt != NT_BIOP_SUB))
+      continue;
+
+    Node poly[SIMPLIFY_POW_MAX + 1];
+    Node_Index first, var = vars[i];
+
+    int degree = pr_collect_poly(nodes, i, stack, poly, &first);
+    if (degree < 0) {
+      // parts of sum are not folded either;
+      for (Node_Index j = first; j < i; ++j)
+        vars[j] = POLY_NONE;
+      continue;
+    }
+
+    if (coefs_len + degree + 1 > coefs_cap) {
+      coefs_cap = MAX(coefs_cap * 2, coefs_len + degree + 1);
+      Node *grown = realloc(coefs, coefs_cap * sizeof(Node));
+      if (grown == NULL) {
+        err = ERR_PR_MEMORY_NOT_ENOUGH;
+        goto final;
+      }
+      coefs = grown;
+    }
+
+    STATS_INC(pr->lx.rd.stats, rules[SR_POLY]);
+    memcpy(&coefs[coefs_len], poly, (degree + 1) * sizeof(Node));
+    nodes[i] = (Node){
+        .type = NT_POLY,
+        .as.up = {.nhs = var, .poly = {.coefs = coefs_len, .degree = degree}},
+    };
+    coefs_len += degree + 1;
+
+    for (Node_Index j = first; j < i; ++j)
+      vars[j] = j == var ? POLY_NONE : POLY_DROPPED;
+  }
+
+  if (coefs_len == 0)
+    goto final;
+
+  // variables are not needed anymore, they take new indices of nodes plus one;
+  Node_Index *after = vars, n = 0;
+  for (Node_Index i = 0; i < len; ++i) {
+    n += vars[i] != POLY_DROPPED;
+    after[i] = n;
+  }
+
+  for (Node_Index i = 0; i < len; ++i) {
+    if (after[i] == (i != 0 ? after[i - 1] : 0))
+      continue;
+
+    Node nd = nodes[i];
+    pr_nd_remap(&nd, after);
+    if (nd.type == NT_POLY)
+      nd.as.up.poly.coefs = nodes[i].as.up.poly.coefs + n;
+
+    nodes[after[i] - 1] = nd;
+    if (pr->nodes_pos != NULL)
+      pr->nodes_pos[after[i] - 1] = pr->nodes_pos[i];
+  }
+
+  // every polynomial drops more nodes than it takes for coefficients;
+  memcpy(&nodes[n], coefs, coefs_len * sizeof(Node));
+  if (pr->nodes_pos != NULL)
+    memset(&pr->nodes_pos[n], 0, coefs_len * sizeof(Node_Pos));
+
+  pr->nodes_len = n + coefs_len;
+  *root = after[*root] - 1;
+  *exec_len = *exec_len != 0 ? after[*exec_len - 1] : 0;
+
+final:
+  free(vars);
+  free(stack);
+  free(coefs);
+  return err;
+}
+
+//=:parser:ops
+
+// Op - operation executed for a node. Operation of a node is its type, but
+// symbols read as values are loaded by OP_LOAD, and frequent pairs of nodes
+// are fused into one operation of the first node, the second one is skipped.
+// Pairs were chosen by counts of adjacent nodes executed by benchmark corpora
+// and reductions;
+typedef uint8_t Op;
+
+enum {
+  // variable pushed by its value;
+  OP_LOAD = NT_COUNT,
+  // literal, then binary operator taking it as rhs;
+  OP_CMX_BIOP,
+  // variable, then binary operator taking it as rhs;
+  OP_LOAD_BIOP,
+  // binary operator, then binary operator taking its result as rhs;
+  OP_BIOP_BIOP,
+  // unary operator, then binary operator taking its result as rhs;
+  OP_UNOP_BIOP,
+  // the first node of a subtree evaluated by a thread of its own;
+  OP_TASK,
+  // the first node of an alternative of a conditional, after its test;
+  OP_BRANCH,
+  // the first node of a conditional, alternatives of which are ranged;
+  OP_RANGE,
+  // reduction, whose body assigns variables, evaluated by one thread;
+  OP_REDUCE_SERIAL,
+  OP_COUNT,
+};
+
+// is_fusable_biop - reports whether binary operator only applies itself to
+// two values;
+static inline bool is_fusable_biop(Node_Type nt) {
+  return (nt >= NT_BIOP_GRE && nt <= NT_BIOP_POW) || nt == NT_BIOP_FAC;
+}
+
+// op_unfused - returns operation of the first node of pair, which is op
+// when the pair is not fused;
+static inline Op op_unfused(Op op, Node_Type type) {
+  switch (op) {
+  case OP_CMX_BIOP:  return NT_PRIM_CMX;
+  case OP_LOAD_BIOP: return OP_LOAD;
+  case OP_BIOP_BIOP:
+  case OP_UNOP_BIOP: return type;
+  default:           return op;
+  }
+}
+
+// pr_compile_ops - sets operations of nodes of program. Pairs are fused only
+// within ranges executed as a whole, which are the program and bodies of
+// reductions and functions, and not when nodes are profiled one by one;
+static ERR pr_compile_ops(Parser *pr, Node_Index exec_len, Op ops[static 1]) {
+  const Node *nodes = pr->nodes;
+  Node_Index len = pr->nodes_len;
+
+  // bodies are rare, their ends are only marked when present;
+  bool *last = NULL;
+
+  // assigned variables and variables of reductions are pushed as symbols;
+  for (Node_Index i = 0; i < len; ++i) {
+    ops[i] = nodes[i].type;
+
+    switch (nodes[i].type) {
+    case NT_PRIM_SYM:
+      if (nodes[i].as.pm.slot != SLOT_NONE)
+        ops[i] = OP_LOAD;
+      break;
+    case NT_BIOP_LET:
+      if (nodes[nodes[i].as.bp.lhs].type == NT_PRIM_SYM)
+        ops[nodes[i].as.bp.lhs] = NT_PRIM_SYM;
+      break;
+    case NT_REDUCE: {
+      if (last == NULL && (last = calloc(len, sizeof(bool))) == NULL)
+        return ERR_PR_MEMORY_NOT_ENOUGH;
+
+      Node_Index args = nodes[i].as.bp.rhs;
+      last[nodes[args].as.bp.rhs_upper] = true;
+
+      for (int j = 0; j < 3; ++j)
+        args = nodes[args].as.bp.lhs;
+      ops[args] = NT_PRIM_SYM;
+      break;
+    }
+    case NT_DEFINE:
+      if (last == NULL && (last = calloc(len, sizeof(bool))) == NULL)
+        return ERR_PR_MEMORY_NOT_ENOUGH;
+
+      last[nodes[i].as.bp.rhs_upper] = true;
+      break;
+    default: break;
+    }
+  }
+
+  for (Node_Index i = 0; pr->nodes_pos == NULL && i + 1 < len; ++i) {
+    if (i + 1 == exec_len || (last != NULL && last[i]) ||
+        !is_fusable_biop(nodes[i + 1].type))
+      continue;
+
+    if (ops[i] == NT_PRIM_CMX)
+      ops[i] = OP_CMX_BIOP;
+    else if (ops[i] == OP_LOAD)
+      ops[i] = OP_LOAD_BIOP;
+    else if (is_fusable_biop(ops[i]))
+      ops[i] = OP_BIOP_BIOP;
+    else if (is_unop(ops[i]))
+      ops[i] = OP_UNOP_BIOP;
+    else
+      continue;
+
+    ++i;
+  }
+
+  free(last);
+  return ERR_NOERROR;
+}
+
+//=:parser:branches
+
+// conditionals: test -> value is value, when test holds. Alternatives follow
+// it after commas, so t1 -> a, t2 -> b, c is a when t1 holds, b when t2 does
+// and c otherwise. Only the taken alternative is evaluated, and a conditional
+// fails, when none of them is taken;
+
+// pr_lower_branches - turns separators of alternatives into NT_ELSE. Separator
+// is one, when its lhs is a conditional or NT_ELSE ending with a conditional,
+// so a conditional is an argument of a reduction only in parentheses;
+static void pr_lower_branches(Parser *pr) {
+  Node *nodes = pr->nodes;
+
+  for (Node_Index i = 1; i < pr->nodes_len; ++i) {
+    if (nodes[i].type != NT_BIOP_SEP)
+      continue;
+
+    const Node *lhs = &nodes[nodes[i].as.bp.lhs];
+    if (lhs->type == NT_BIOP_SPZ ||
+        (lhs->type == NT_ELSE && nodes[lhs->as.bp.rhs].type == NT_BIOP_SPZ))
+      nodes[i].type = NT_ELSE;
+  }
+}
+
+// pr_mark_lazy - sets *lazy to marks of nodes, which are evaluated only by
+// taken alternatives, or to NULL, when program has no conditionals;
+static ERR pr_mark_lazy(const Node *nodes, Node_Index len, bool *lazy[static 1]) {
+  *lazy = NULL;
+
+  for (Node_Index i = 1; i < len; ++i) {
+    if (nodes[i].type != NT_BIOP_SPZ && nodes[i].type != NT_ELSE)
+      continue;
+
+    if (*lazy == NULL && (*lazy = calloc(len, sizeof(bool))) == NULL)
+      return ERR_PR_MEMORY_NOT_ENOUGH;
+
+    for (Node_Index j = nodes[i].as.bp.rhs_lower; j <= nodes[i].as.bp.rhs_upper;
+         ++j)
+      (*lazy)[j] = true;
+  }
+
+  return ERR_NOERROR;
+}
+
+// Branch - alternative of a conditional, nodes from begin to its NT_BIOP_SPZ
+// are executed, when its test holds, and execution goes on at done after the
+// conditional. Otherwise it goes on at miss, the next alternative, or fails,
+// when miss is 0;
+typedef struct {
+  Node_Index begin;
+  Node_Index miss;
+  Node_Index done;
+  // operation of the first node, OP_BRANCH takes its place;
+  Op op;
+} Branch;
+
+static int branch_cmp(const void *a, const void *b) {
+  const Branch *x = a, *y = b;
+  return (x->begin > y->begin) - (x->begin < y->begin);
+}
+
+// pr_plan_branches - sets alternatives of conditionals of program, ordered by
+// their first nodes;
+static ERR pr_plan_branches(Parser *pr, Op ops[static 1],
+                     Branch *branches_out[static 1],
+                     Node_Index branches_len[static 1]) {
+  const Node *nodes = pr->nodes;
+  Node_Index len = pr->nodes_len, n = 0;
+
+  *branches_out = NULL;
+  *branches_len = 0;
+
+  for (Node_Index i = 1; i < len; ++i)
+    n += nodes[i].type == NT_BIOP_SPZ;
+  if (n == 0)
+    return ERR_NOERROR;
+
+  // the last node of conditional of an alternative, and whether another
+  // alternative follows it;
+  Node_Index *root = calloc(len, sizeof(Node_Index));
+  bool *next = calloc(len, sizeof(bool));
+  Branch *branches = malloc(n * sizeof(Branch));
+
+  if (root == NULL || next == NULL || branches == NULL) {
+    free(root);
+    free(next);
+    free(branches);
+    return ERR_PR_MEMORY_NOT_ENOUGH;
+  }
+
+  // parents follow their children, so conditionals are walked from roots;
+  for (Node_Index i = len - 1; i > 0; --i) {
+    if (nodes[i].type != NT_ELSE)
+      continue;
+
+    if (root[i] == 0)
+      root[i] = i;
+
+    Node_Index lhs = nodes[i].as.bp.lhs, rhs = nodes[i].as.bp.rhs;
+    root[lhs] = root[i];
+    next[lhs] = true;
+
+    if (nodes[rhs].type == NT_BIOP_SPZ) {
+      root[rhs] = root[i];
+      next[rhs] = next[i];
+    }
+  }
+
+  n = 0;
+  for (Node_Index i = 1; i < len; ++i) {
+    if (nodes[i].type != NT_BIOP_SPZ)
+      continue;
+
+    Node_Index begin = nodes[i].as.bp.rhs_lower;
+    branches[n++] = (Branch){
+        .begin = begin,
+        .miss = next[i] ? i + 1 : 0,
+        .done = (root[i] != 0 ? root[i] : i) + 1,
+        .op = ops[begin],
+    };
+    ops[begin] = OP_BRANCH;
+  }
+
+  qsort(branches, n, sizeof(Branch), branch_cmp);
+
+  free(root);
+  free(next);
+  *branches_out = branches;
+  *branches_len = n;
+  return ERR_NOERROR;
+}
+
+//=:parser:ranges
+
+// ranged conditionals: tests of x < c1 -> a, x < c2 -> b, ... with literals
+// c1 <= c2 <= ..., or of x > c1 -> a, x > c2 -> b, ... with c1 >= c2 >= ...,
+// hold from the first holding one on. So the taken alternative is found by
+// binary search of literals, instead of evaluation of tests one by one;
+
+// Range_Bound - literal of test of an alternative, and the first node after
+// the test, which is executed by op instead of OP_BRANCH;
+typedef struct {
+  double bound;
+  Node_Index begin;
+  Op op;
+} Range_Bound;
+
+// Range - leading alternatives [bounds, bounds + len) of conditional, tests of
+// which compare variable of node begin by type. Execution goes on at miss,
+// when none of them holds, or fails, when miss is 0;
+typedef struct {
+  Node_Index begin;
+  Node_Index bounds;
+  Node_Index len;
+  Node_Index miss;
+  Node_Type type;
+  // operation of the first node, OP_RANGE takes its place;
+  Op op;
+} Range;
+
+static int range_cmp(const void *a, const void *b) {
+  const Range *x = a, *y = b;
+  return (x->begin > y->begin) - (x->begin < y->begin);
+}
+
+// pr_range_test - returns test of alternative, when it compares variable with
+// real literal by < or >, or 0;
+static Node_Index pr_range_test(const Node *nodes, Node_Index alt) {
+  Node_Index test = nodes[alt].as.bp.lhs;
+  const Node *nd = &nodes[test];
+
+  if (nd->type != NT_BIOP_LES && nd->type != NT_BIOP_GRE)
+    return 0;
+  if (nd->as.bp.lhs != test - 2 || nd->as.bp.rhs != test - 1)
+    return 0;
+  if (nodes[test - 2].type != NT_PRIM_SYM ||
+      nodes[test - 1].type != NT_PRIM_CMX ||
+      cimag(nodes[test - 1].as.pm.c) != 0 ||
+      isnan(creal(nodes[test - 1].as.pm.c)))
+    return 0;
+
+  return test;
+}
+
+// pr_plan_ranges - sets ranged leading alternatives of conditionals of
+// program, ordered by their first nodes, and bounds of all of them. Ranges
+// are planned before alternatives, which execute OP_RANGE as their own;
+static ERR pr_plan_ranges(Parser *pr, Op ops[static 1], Range *ranges_out[static 1],
+                   Node_Index ranges_len[static 1],
+                   Range_Bound *bounds_out[static 1]) {
+  const Node *nodes = pr->nodes;
+  Node_Index len = pr->nodes_len, alts_max = 0;
+
+  *ranges_out = NULL;
+  *ranges_len = 0;
+  *bounds_out = NULL;
+
+  for (Node_Index i = 1; i < len; ++i)
+    alts_max += nodes[i].type == NT_BIOP_SPZ;
+  if (alts_max < RANGE_ALTERNATIVES_MIN)
+    return ERR_NOERROR;
+
+  // NT_ELSE nodes, which are lhs of another one, and alternatives of a
+  // conditional from the last one;
+  bool *inner = calloc(len, sizeof(bool));
+  Node_Index *alts = malloc(alts_max * sizeof(Node_Index));
+  Range *ranges = malloc(alts_max / RANGE_ALTERNATIVES_MIN * sizeof(Range));
+  Range_Bound *bounds = malloc(alts_max * sizeof(Range_Bound));
+
+  if (inner == NULL || alts == NULL || ranges == NULL || bounds == NULL) {
+    free(inner);
+    free(alts);
+    free(ranges);
+    free(bounds);
+    return ERR_PR_MEMORY_NOT_ENOUGH;
+  }
+
+  for (Node_Index i = 1; i < len; ++i) {
+    if (nodes[i].type == NT_ELSE)
+      inner[nodes[i].as.bp.lhs] = true;
+  }
+
+  Node_Index n = 0, m = 0;
+  for (Node_Index i = 1; i < len; ++i) {
+    if (nodes[i].type != NT_ELSE || inner[i])
+      continue;
+
+    Node_Index alts_len = 0, node = i;
+    for (; nodes[node].type == NT_ELSE; node = nodes[node].as.bp.lhs) {
+      if (nodes[nodes[node].as.bp.rhs].type == NT_BIOP_SPZ)
+        alts[alts_len++] = nodes[node].as.bp.rhs;
+    }
+    alts[alts_len++] = node;
+
+    // variable of the first test is pushed by the first node of conditional,
+    // unless it begins a task;
+    Node_Index first = pr_range_test(nodes, node), k = 0;
+    if (alts_len < RANGE_ALTERNATIVES_MIN || first == 0 ||
+        ops[first - 2] != OP_LOAD)
+      continue;
+
+    Node_Type type = nodes[first].type;
+    for (Node_Index j = alts_len; j-- > 0; ++k) {
+      Node_Index test = pr_range_test(nodes, alts[j]);
+      if (test == 0 || nodes[test].type != type ||
+          nodes[test - 2].as.pm.slot != nodes[first - 2].as.pm.slot)
+        break;
+
+      double bound = creal(nodes[test - 1].as.pm.c);
+      if (k != 0 && (type == NT_BIOP_LES ? bound < bounds[m + k - 1].bound
+                                         : bound > bounds[m + k - 1].bound))
+        break;
+
+      bounds[m + k] = (Range_Bound){
+          .bound = bound,
+          .begin = nodes[alts[j]].as.bp.rhs_lower,
+      };
+    }
+
+    if (k < RANGE_ALTERNATIVES_MIN)
+      continue;
+
+    // the last ranged alternative misses as it does without ranges;
+    bool otherwise = k < alts_len || nodes[nodes[i].as.bp.rhs].type != NT_BIOP_SPZ;
+    ranges[n++] = (Range){
+        .begin = first - 2,
+        .bounds = m,
+        .len = k,
+        .miss = otherwise ? alts[alts_len - k] + 1 : 0,
+        .type = type,
+        .op = ops[first - 2],
+    };
+    ops[first - 2] = OP_RANGE;
+    m += k;
+  }
+
+  // the first node of an alternative may begin a ranged conditional;
+  for (Node_Index j = 0; j < m; ++j)
+    bounds[j].op = ops[bounds[j].begin];
+
+  qsort(ranges, n, sizeof(Range), range_cmp);
+
+  free(inner);
+  free(alts);
+  if (n == 0) {
+    free(ranges);
+    free(bounds);
+    return ERR_NOERROR;
+  }
+
+  *ranges_out = ranges;
+  *ranges_len = n;
+  *bounds_out = bounds;
+  return ERR_NOERROR;
+}
+
+//=:parser:tasks
+
+// Task - subtree of nodes [begin, end] evaluated by a thread of its own.
+// Tasks of a group are independent of each other, they are evaluated together
+// when the first of them is reached and the rest take their values then;
+typedef struct {
+  Node_Index begin;
+  Node_Index end;
+  // number of tasks of group, counted by its first task, 0 for the others;
+  Node_Index group_len;
+  // operation of the first node, OP_TASK takes its place;
+  Op op;
+} Task;
+
+// estimated costs of nodes, in costs of an arithmetic operator;
+enum {
+  COST_CALL = 2,
+  COST_POW = 6,
+  // multifactorial of step s costs COST_FAC_STEP * s^2;
+  COST_FAC_STEP = 3,
+  COST_SUBFAC = 96,
+};
+
+// pr_nd_cost - returns estimated cost of node without its children;
+static inline double pr_nd_cost(const Node *nodes, Node_Index node) {
+  switch (nodes[node].type) {
+  case NT_BIOP_POW: return COST_POW;
+  case NT_UNOP_NOT: return COST_SUBFAC;
+  case NT_CALL:     return COST_CALL;
+  case NT_BIOP_FAC: {
+    // step of multifactorial is a literal made of its exclamation marks;
+    double step = creal(nodes[nodes[node].as.bp.rhs].as.pm.c);
+    return MAX(COST_FAC_STEP * step * step, 1);
+  }
+  default: return 1;
+  }
+}
+
+// pr_nd_pure_children - sets children of node, which may be evaluated apart
+// from the rest of program, returns their number or -1 for other nodes.
+// Reductions, assignments and sequences are not, so subtrees of pure nodes
+// only read variables and leave a single value;
+static inline int pr_nd_pure_children(const Node *nodes, Node_Index node,
+                                      Node_Index children[static 2]) {
+  const Node *nd = &nodes[node];
+
+  switch (nd->type) {
+  case NT_PRIM_SYM:
+  case NT_PRIM_CMX:
+  case NT_PRIM_PRB:
+    return 0;
+  case NT_UNOP_ABS:
+  case NT_UNOP_NOT:
+  case NT_UNOP_NOP:
+  case NT_UNOP_NEG:
+  case NT_POWI:
+  case NT_POLY:
+    children[0] = nd->as.up.nhs;
+    return 1;
+  case NT_CALL:
+    if (nodes[nd->as.bp.rhs].type == NT_BIOP_SEP)
+      return -1;
+    break;
+  default:
+    if (!is_fusable_biop(nd->type))
+      return -1;
+    break;
+  }
+
+  children[0] = nd->as.bp.lhs;
+  children[1] = nd->as.bp.rhs;
+  return 2;
+}
+
+// pr_nd_pure_subtree - sets pure[node] and first[node] by children of node,
+// which precede it, returns their number as pr_nd_pure_children does. Subtree
+// of a pure node is contiguous and ends with the node;
+static inline int pr_nd_pure_subtree(const Node *nodes, Node_Index node,
+                                     bool pure[static 1],
+                                     Node_Index first[static 1],
+                                     Node_Index children[static 2]) {
+  int len = pr_nd_pure_children(nodes, node, children);
+
+  first[node] = node;
+  pure[node] = len >= 0;
+
+  for (int j = 0; j < len; ++j)
+    pure[node] = pure[node] && children[j] < node && pure[children[j]];
+
+  if (pure[node] && len > 0) {
+    first[node] = first[children[0]];
+    pure[node] = children[len - 1] == node - 1 &&
+                 (len == 1 || first[children[1]] == children[0] + 1);
+  }
+
+  return len;
+}
+
+// pr_plan_tasks - groups heavy independent subtrees of program into tasks.
+// Subtree of a pure node, whose parent is not pure, is split at nodes with two
+// children estimated to cost at least TASK_COST_MIN, and where only one child
+// is heavy, the split goes on in it. Groups of less than two tasks are
+// dropped. Nothing is planned for programs made of arithmetic operators only,
+// which are cheaper to evaluate than to plan, in alternatives of conditionals,
+// which may be not taken, and when nodes are profiled one by one;
+static ERR pr_plan_tasks(Parser *pr, Op ops[static 1], Task *tasks_out[static 1],
+                  Node_Index tasks_len[static 1]) {
+  const Node *nodes = pr->nodes;
+  Node_Index len = pr->nodes_len, cap = 0, n = 0;
+
+  *tasks_out = NULL;
+  *tasks_len = 0;
+  if (pr->nodes_pos != NULL)
+    return ERR_NOERROR;
+
+  bool costly = false;
+  for (Node_Index i = 0; i < len && !costly; ++i)
+    costly = pr_nd_cost(nodes, i) > 1;
+  if (!costly)
+    return ERR_NOERROR;
+
+  double *cost = malloc(len * sizeof(double));
+  Node_Index *first = malloc(len * sizeof(Node_Index));
+  Node_Index *pending = malloc(len * sizeof(Node_Index));
+  bool *pure = calloc(len, sizeof(bool));
+  bool *covered = calloc(len, sizeof(bool));
+  bool *lazy = NULL;
+  Task *tasks = NULL;
+
+  ERR err = ERR_NOERROR;
+  if (cost == NULL || first == NULL || pending == NULL || pure == NULL ||
+      covered == NULL) {
+    err = ERR_PR_MEMORY_NOT_ENOUGH;
+    goto final;
+  }
+
+  err = pr_mark_lazy(nodes, len, &lazy);
+  if (err != ERR_NOERROR)
+    goto final;
+
+  for (Node_Index i = 0; i < len; ++i) {
+    Node_Index ch[2];
+    int ch_len = pr_nd_pure_subtree(nodes, i, pure, first, ch);
+
+    cost[i] = pr_nd_cost(nodes, i);
+    for (int j = 0; pure[i] && j < ch_len; ++j) {
+      cost[i] += cost[ch[j]];
+      covered[ch[j]] = true;
+    }
+  }
+
+  for (Node_Index root = 0; root < len; ++root) {
+    if (!pure[root] || covered[root] || (lazy != NULL && lazy[root]) ||
+        cost[root] < TASK_COST_MIN)
+      continue;
+
+    Node_Index group = n, pending_len = 0;
+    pending[pending_len++] = root;
+
+    while (pending_len != 0) {
+      Node_Index node = pending[--pending_len], ch[2], heavy[2];
+      int ch_len = pr_nd_pure_children(nodes, node, ch), heavy_len = 0;
+
+      for (int j = 0; j < ch_len; ++j)
+        if (cost[ch[j]] >= TASK_COST_MIN)
+          heavy[heavy_len++] = ch[j];
+
+      // the left subtree is split first, so tasks are ordered by nodes;
+      if (heavy_len != 0 && pr_nd_cost(nodes, node) < TASK_COST_MIN) {
+        while (heavy_len != 0)
+          pending[pending_len++] = heavy[--heavy_len];
+        continue;
+      }
+
+      if (n == cap) {
+        cap = cap ? cap * 2 : 8;
+        Task *grown = realloc(tasks, cap * sizeof(Task));
+        if (grown == NULL) {
+          err = ERR_PR_MEMORY_NOT_ENOUGH;
+          goto final;
+        }
+        tasks = grown;
+      }
+
+      tasks[n++] = (Task){.begin = first[node], .end = node};
+    }
+
+    if (n - group < 2)
+      n = group;
+    else
+      tasks[group].group_len = n - group;
+  }
+
+  // the last node of a task must not be fused with the node after it;
+  for (Node_Index i = 0; i < n; ++i) {
+    ops[tasks[i].end] = op_unfused(ops[tasks[i].end], nodes[tasks[i].end].type);
+    tasks[i].op = ops[tasks[i].begin];
+    ops[tasks[i].begin] = OP_TASK;
+  }
+
+  if (n == 0) {
+    free(tasks);
+    tasks = NULL;
+  }
+
+  *tasks_out = tasks;
+  *tasks_len = n;
+
+final:
+  if (err != ERR_NOERROR)
+    free(tasks);
+
+  free(cost);
+  free(first);
+  free(pending);
+  free(pure);
+  free(covered);
+  free(lazy);
+  return err;
+}
+
+//=:parser:stack
+
+// pr_stack_depth - returns max number of values on the stack while nodes
+// [begin, end) are executed, bodies of reductions are executed on top of the
+// stack left by their arguments. Alternatives of conditionals are counted as
+// if all of them were executed;
+static Node_Index pr_stack_depth(const Node nodes[static 1], Node_Index begin,
+                          Node_Index end) {
+  Node_Index len = 0, depth = 0;
+
+  for (Node_Index i = begin; i < end; ++i) {
+    const Node *nd = &nodes[i];
+    Node_Index pops = 0, pushes = 0;
+
+    switch (nd->type) {
+    case NT_PRIM_SYM:
+    case NT_PRIM_CMX:
+      pushes = 1;
+      break;
+    case NT_BIOP_LET:
+      pops = 2;
+      break;
+    case NT_BIOP_XPC:
+      pushes = ir_nd_yields(nodes, nd->as.bp.rhs);
+      pops = pushes + ir_nd_yields(nodes, nd->as.bp.lhs);
+      break;
+    case NT_BIOP_GRE:
+    case NT_BIOP_LES:
+    case NT_BIOP_GEQ:
+    case NT_BIOP_LEQ:
+    case NT_BIOP_EQU:
+    case NT_BIOP_NEQ:
+    case NT_BIOP_ADD:
+    case NT_BIOP_SUB:
+    case NT_BIOP_APX:
+    case NT_BIOP_MUL:
+    case NT_BIOP_QUO:
+    case NT_BIOP_MOD:
+    case NT_BIOP_POW:
+    case NT_BIOP_FAC:
+    case NT_CALL:
+    case NT_ELSE:
+      pops = 2, pushes = 1;
+      break;
+    case NT_APPLY:
+      // body is executed on top of the stack left by the call;
+      pops = 1 + nd_args_len(nodes, i), pushes = 1;
+      break;
+    case NT_BIOP_SPZ:
+      // test is popped before alternative is executed, so counting it till
+      // then only overestimates;
+      pops = 2, pushes = 1;
+      break;
+    case NT_UNOP_ABS:
+    case NT_UNOP_NOT:
+    case NT_UNOP_NOP:
+    case NT_UNOP_NEG:
+    case NT_SAVE:
+    case NT_POWI:
+    case NT_POLY:
+      pops = 1, pushes = 1;
+      break;
+    case NT_REDUCE: {
+      // symbol, variable and bounds are popped before body is executed;
+      pops = MIN(len, 4), pushes = 1;
+
+      const Bi_Op *args = &nodes[nd->as.bp.rhs].as.bp;
+      Node_Index body = pr_stack_depth(nodes, args->rhs_lower,
+                                       args->rhs_upper + 1);
+      depth = MAX(depth, len - pops + body);
+      break;
+    }
+    default:
+      break;
+    }
+
+    // pops of missing values fail when executed;
+    len = (len < pops ? 0 : len - pops) + pushes;
+    depth = MAX(depth, len);
+  }
+
+  return depth;
+}
+
+//=:parser:sharing
+
+// nodes of a replaced subtree but its last one, which are dropped;
+#define SHARE_DROPPED (UINT32_MAX)
+
+// share_mix - mixes word into hash, high bits are folded into low ones, which
+// index entries, as low bits of numbers are often zero;
+static inline uint64_t share_mix(uint64_t hash, uint64_t word) {
+  hash = (hash ^ word) * 0x9e3779b97f4a7c15;
+  return hash ^ (hash >> 32);
+}
+
+// pr_nd_hash - returns hash of structure of pure node, its children are
+// given by their hashes;
+static inline uint64_t pr_nd_hash(const Node *nodes, Node_Index node,
+                                  const uint64_t hashes[static 1]) {
+  const Node *nd = &nodes[node];
+  uint64_t hash = share_mix(0xcbf29ce484222325, nd->type), bits[2];
+
+  switch (nd->type) {
+  case NT_PRIM_SYM:
+    return share_mix(share_mix(hash, nd->as.pm.s), nd->as.pm.slot);
+  case NT_PRIM_CMX:
+  case NT_PRIM_PRB:
+    memcpy(bits, &nd->as.pm.c, sizeof bits);
+    return share_mix(share_mix(hash, bits[0]), bits[1]);
+  case NT_UNOP_ABS:
+  case NT_UNOP_NOT:
+  case NT_UNOP_NOP:
+  case NT_UNOP_NEG:
+    return share_mix(hash, hashes[nd->as.up.nhs]);
+  case NT_POWI:
+    return share_mix(share_mix(hash, hashes[nd->as.up.nhs]), nd->as.up.exp);
+  case NT_POLY:
+    return share_mix(share_mix(hash, hashes[nd->as.up.nhs]),
+        nd->as.up.poly.degree);
+  default:
+    return share_mix(share_mix(hash, hashes[nd->as.bp.lhs]),
+        hashes[nd->as.bp.rhs]);
+  }
+}
+
+// pr_nd_same - reports whether pure subtrees ending with nodes a and b are
+// the same. They are contiguous, so their nodes are compared one by one, and
+// children by their offsets in subtrees;
+static inline bool pr_nd_same(const Node *nodes, const Node_Index first[static 1],
+                              Node_Index a, Node_Index b) {
+  Node_Index fa = first[a], fb = first[b];
+  if (a - fa != b - fb)
+    return false;
+
+  for (Node_Index i = 0; i <= a - fa; ++i) {
+    const Node *x = &nodes[fa + i], *y = &nodes[fb + i];
+    if (x->type != y->type)
+      return false;
+
+    switch (x->type) {
+    case NT_PRIM_SYM:
+      if (x->as.pm.s != y->as.pm.s || x->as.pm.slot != y->as.pm.slot)
+        return false;
+      break;
+    case NT_PRIM_CMX:
+    case NT_PRIM_PRB:
+      // literals of different signs of zero are not the same;
+      if (memcmp(&x->as.pm.c, &y->as.pm.c, sizeof(cmx_t)) != 0 ||
+          x->rel_err != y->rel_err)
+        return false;
+      break;
+    case NT_UNOP_ABS:
+    case NT_UNOP_NOT:
+    case NT_UNOP_NOP:
+    case NT_UNOP_NEG:
+      if (x->as.up.nhs - fa != y->as.up.nhs - fb)
+        return false;
+      break;
+    case NT_POWI:
+      if (x->as.up.nhs - fa != y->as.up.nhs - fb ||
+          x->as.up.exp != y->as.up.exp)
+        return false;
+      break;
+    case NT_POLY:
+      if (x->as.up.nhs - fa != y->as.up.nhs - fb ||
+          x->as.up.poly.degree != y->as.up.poly.degree)
+        return false;
+
+      for (uint32_t k = 0; k <= x->as.up.poly.degree; ++k) {
+        const Node *cx = &nodes[x->as.up.poly.coefs + k];
+        const Node *cy = &nodes[y->as.up.poly.coefs + k];
+        if (memcmp(&cx->as.pm.c, &cy->as.pm.c, sizeof(cmx_t)) != 0 ||
+            cx->rel_err != cy->rel_err)
+          return false;
+      }
+      break;
+    default:
+      if (x->as.bp.lhs - fa != y->as.bp.lhs - fb ||
+          x->as.bp.rhs - fa != y->as.bp.rhs - fb)
+        return false;
+      break;
+    }
+  }
+
+  return true;
+}
+
+// pr_share_subtrees - evaluates repeated subtrees once. Pure subtrees of at
+// least SHARE_NODES_MIN nodes, which read variables, are hashed by structure,
+// and a subtree, which is the same as an earlier one of the same region, is
+// replaced by a symbol node of a temporary slot, NT_SAVE after the earlier one
+// writes its value there. Regions are the program, bodies of reductions and
+// functions and alternatives of conditionals, cut by assignments, reductions,
+// conditionals and calls of functions, so variables keep their values within a
+// region, values saved by an alternative are read only by it, and a call does
+// not overwrite them before they are read. Temporary slots follow slots of
+// variables and are added to *slots_temp. Subtrees of literals are left to
+// folding, and nothing is shared when nodes are profiled one by one;
+static ERR pr_share_subtrees(Parser *pr, Node_Index root[static 1],
+                      Node_Index exec_len[static 1], Slot slots_len[static 1],
+                      Slot slots_temp[static 1]) {
+  Node_Index len = pr->nodes_len, candidates = 0;
+
+  if (pr->nodes_pos != NULL || *slots_len == 0 ||
+      len < SHARE_NODES_MIN * 2 + 2)
+    return ERR_NOERROR;
+
+  uint64_t *hashes = malloc(len * sizeof(uint64_t));
+  Node_Index *first = malloc(len * sizeof(Node_Index));
+  Node_Index *shared = calloc(len, sizeof(Node_Index));
+  bool *pure = calloc(len, sizeof(bool));
+  bool *reads = calloc(len, sizeof(bool));
+  Node_Index *seen = NULL;
+
+  // bodies and alternatives are rare, their starts are marked when present;
+  bool *starts = NULL;
+
+  ERR err = ERR_NOERROR;
+  if (hashes == NULL || first == NULL || shared == NULL || pure == NULL ||
+      reads == NULL) {
+    err = ERR_PR_MEMORY_NOT_ENOUGH;
+    goto final;
+  }
+
+  for (Node_Index i = 1; i < len; ++i) {
+    const Node *nd = &pr->nodes[i];
+    Node_Index ch[2];
+
+    int ch_len = pr_nd_pure_subtree(pr->nodes, i, pure, first, ch);
+    if (pure[i]) {
+      hashes[i] = pr_nd_hash(pr->nodes, i, hashes);
+      reads[i] = nd->type == NT_PRIM_SYM && nd->as.pm.slot != SLOT_NONE;
+      for (int j = 0; j < ch_len; ++j)
+        reads[i] = reads[i] || reads[ch[j]];
+    }
+
+    if (reads[i] && i - first[i] + 1 >= SHARE_NODES_MIN)
+      ++candidates;
+
+    // assigned subtree stays as it is, so assigning to it fails;
+    if (nd->type == NT_BIOP_LET)
+      reads[nd->as.bp.lhs] = false;
+
+    if (nd->type == NT_REDUCE || nd->type == NT_BIOP_SPZ ||
+        nd->type == NT_ELSE || nd->type == NT_DEFINE) {
+      if (starts == NULL && (starts = calloc(len, sizeof(bool))) == NULL) {
+        err = ERR_PR_MEMORY_NOT_ENOUGH;
+        goto final;
+      }
+
+      const Node *body = nd->type == NT_REDUCE ? &pr->nodes[nd->as.bp.rhs] : nd;
+      starts[body->as.bp.rhs_lower] = true;
+
+      // head of a function is not in region of the body before it;
+      if (nd->type == NT_DEFINE)
+        starts[pr->nodes[nd->as.bp.lhs].as.bp.lhs] = true;
+    }
+  }
+
+  if (candidates < 2)
+    goto final;
+
+  // subtrees are looked up by open addressing, node 0 is not a subtree and
+  // marks empty entries;
+  size_t cap = 1;
+  while (cap < (size_t)candidates * 2)
+    cap *= 2;
+
+  seen = calloc(cap, sizeof(Node_Index));
+  if (seen == NULL) {
+    err = ERR_PR_MEMORY_NOT_ENOUGH;
+    goto final;
+  }
+
+  // regions are contiguous, so earlier subtree of the region of a node is not
+  // before its start. Subtrees are only replaced by the first of them in
+  // region, so it is never a part of a replaced subtree: a part of the first
+  // one would come earlier;
+  Node_Index region = 1;
+  bool found = false;
+  for (Node_Index i = 1; i < len; ++i) {
+    if (i == *exec_len || (starts != NULL && starts[i]))
+      region = i;
+
+    if (reads[i] && i - first[i] + 1 >= SHARE_NODES_MIN) {
+      size_t at = hashes[i] & (cap - 1);
+      while (seen[at] != 0 && hashes[seen[at]] != hashes[i])
+        at = (at + 1) & (cap - 1);
+
+      Node_Index earlier = seen[at];
+      if (earlier < region) {
+        seen[at] = i;
+      } else if (pr_nd_same(pr->nodes, first, earlier, i)) {
+        shared[i] = earlier;
+        found = true;
+      }
+    }
+
+    Node_Type type = pr->nodes[i].type;
+    if (type == NT_BIOP_LET || type == NT_REDUCE || type == NT_BIOP_SPZ ||
+        type == NT_ELSE || type == NT_APPLY)
+      region = i + 1;
+  }
+
+  if (!found)
+    goto final;
+
+  // hashes are not needed anymore, they take temporary slots of saved nodes;
+  uint64_t *temps = hashes;
+  for (Node_Index i = 0; i < len; ++i)
+    temps[i] = SLOT_NONE;
+
+  // the largest repeated subtrees are replaced, repeated parts of them are
+  // dropped together with them;
+  Slot temps_len = 0;
+  for (Node_Index i = len - 1; i > 0; --i) {
+    if (shared[i] == 0)
+      continue;
+
+    if (temps[shared[i]] == SLOT_NONE)
+      temps[shared[i]] = *slots_len + temps_len++;
+
+    for (Node_Index j = first[i]; j < i; ++j)
+      shared[j] = SHARE_DROPPED;
+    i = first[i];
+  }
+
+  // first is not needed anymore, it takes new indices of nodes plus one, a
+  // saved node is followed by its NT_SAVE;
+  Node_Index *after = first, n = 1;
+  after[0] = 1;
+  for (Node_Index i = 1; i < len; ++i) {
+    if (shared[i] != SHARE_DROPPED)
+      n += 1 + (temps[i] != SLOT_NONE);
+    after[i] = n;
+  }
+
+  // nodes are written to a new buffer, which takes place of the old one, so
+  // only pages of nodes left are touched;
+  Node *nodes = malloc(pr->nodes_cap * sizeof(Node));
+  if (nodes == NULL) {
+    err = ERR_PR_MEMORY_NOT_ENOUGH;
+    goto final;
+  }
+  STATS_ALLOC(pr->lx.rd.stats, pr->nodes_cap * sizeof(Node));
+
+  nodes[0] = pr->nodes[0];
+  for (Node_Index i = 1; i < len; ++i) {
+    if (shared[i] == SHARE_DROPPED)
+      continue;
+
+    Node nd = pr->nodes[i];
+    Node_Index at = after[i] - 1 - (temps[i] != SLOT_NONE);
+
+    if (shared[i] != 0) {
+      nd = (Node){
+          .type = NT_PRIM_SYM,
+          .as.pm = {.s = 0, .slot = temps[shared[i]]},
+      };
+    } else {
+      pr_nd_remap(&nd, after);
+    }
+
+    nodes[at] = nd;
+    if (temps[i] != SLOT_NONE)
+      nodes[at + 1] = (Node){
+          .type = NT_SAVE,
+          .as.up = {.nhs = at, .slot = temps[i]},
+      };
+  }
+
+  free(pr->nodes);
+  pr->nodes = nodes;
+  pr->nodes_len = n;
+  *root = after[*root] - 1;
+  *exec_len = *exec_len != 0 ? after[*exec_len - 1] : 0;
+  *slots_len += temps_len;
+  *slots_temp += temps_len;
+
+final:
+  free(hashes);
+  free(first);
+  free(shared);
+  free(pure);
+  free(reads);
+  free(seen);
+  free(starts);
+  return err;
+}
+
+//=:parser:calls
+
+// Function - body of a user function, nodes [begin, end), which reads its
+// parameters from slots [params, params + params_len);
+typedef struct {
+  Node_Index begin;
+  Node_Index end;
+  Slot params;
+  uint32_t params_len;
+  // value of a pure function depends on its arguments only, so it is cached;
+  bool pure;
+} Function;
+
+// pr_nd_impure - reports whether node assigns, reduces or reads a variable;
+static inline bool pr_nd_impure(const Node *nodes, Node_Index node) {
+  const Node *nd = &nodes[node];
+
+  switch (nd->type) {
+  case NT_BIOP_LET:
+  case NT_REDUCE:
+    return true;
+  case NT_PRIM_SYM:
+    return nd->as.pm.s != 0 && nd->as.pm.slot != SLOT_NONE;
+  default:
+    return false;
+  }
+}
+
+// pr_plan_functions - sets functions of program in order of their
+// definitions, symbol of an applied function takes its index instead of a
+// slot. A function is pure, unless nodes of its body are impure or apply an
+// impure function. *depth is set to max number of values on the stack while a
+// body is executed;
+static ERR pr_plan_functions(Parser *pr, Node_Index exec_len,
+                      Function *functions_out[static 1],
+                      Node_Index functions_len[static 1],
+                      Node_Index depth[static 1]) {
+  Node *nodes = pr->nodes;
+  Node_Index n = 0;
+
+  *functions_out = NULL;
+  *functions_len = 0;
+  *depth = 0;
+
+  for (Node_Index i = exec_len; i < pr->nodes_len; ++i)
+    n += nodes[i].type == NT_DEFINE;
+  if (n == 0)
+    return ERR_NOERROR;
+
+  // capacity is odd, so it is not 2^n;
+  size_t cap = n * 2 + 1;
+  Map_Entry_Slot *indices = calloc(cap, sizeof(Map_Entry_Slot));
+  Function *functions = malloc(n * sizeof(Function));
+  if (indices == NULL || functions == NULL) {
+    free(indices);
+    free(functions);
+    return ERR_PR_MEMORY_NOT_ENOUGH;
+  }
+
+  n = 0;
+  for (Node_Index i = exec_len; i < pr->nodes_len; ++i) {
+    if (nodes[i].type != NT_DEFINE)
+      continue;
+
+    // parameters of a function are consecutive, from the first one;
+    Node_Index head = nodes[i].as.bp.lhs, param = nodes[head].as.bp.rhs;
+    while (nodes[param].type == NT_BIOP_SEP)
+      param = nodes[param].as.bp.lhs;
+
+    Function *fn = &functions[n];
+    *fn = (Function){
+        .begin = nodes[i].as.bp.rhs_lower,
+        .end = nodes[i].as.bp.rhs_upper + 1,
+        .params = nodes[param].as.pm.slot,
+        .params_len = nd_args_len(nodes, head),
+        .pure = true,
+    };
+
+    // symbols of applied functions have no slots yet;
+    for (Node_Index j = fn->begin; j < fn->end && fn->pure; ++j)
+      fn->pure = !pr_nd_impure(nodes, j);
+
+    *depth = MAX(*depth, pr_stack_depth(nodes, fn->begin, fn->end));
+    map_set_Slot(indices, cap, nodes[nodes[head].as.bp.lhs].as.pm.s, n++);
+  }
+
+  for (Node_Index i = 1; i < pr->nodes_len; ++i) {
+    if (nodes[i].type != NT_APPLY)
+      continue;
+
+    Node *fn = &nodes[nodes[i].as.bp.lhs];
+    map_get_Slot(indices, cap, fn->as.pm.s, &fn->as.pm.slot);
+  }
+
+  // functions applying impure ones are impure, until none is left;
+  for (bool changed = true; changed;) {
+    changed = false;
+
+    for (Node_Index i = 0; i < n; ++i) {
+      Function *fn = &functions[i];
+      for (Node_Index j = fn->begin; j < fn->end && fn->pure; ++j) {
+        if (nodes[j].type != NT_APPLY)
+          continue;
+
+        fn->pure = functions[nodes[nodes[j].as.bp.lhs].as.pm.slot].pure;
+        changed = changed || !fn->pure;
+      }
+    }
+  }
+
+  free(indices);
+  *functions_out = functions;
+  *functions_len = n;
+  return ERR_NOERROR;
+}
+
+// pr_plan_serial_reductions - marks reductions, whose bodies assign variables
+// or apply impure functions, to be evaluated serially. Threads would evaluate
+// such bodies in copies of slots, each seeing only assignments of its own
+// chunks. Bodies of inner reductions are apart from outer ones, so marks are
+// spread outwards until none is left;
+static void pr_plan_serial_reductions(const Parser *pr,
+                                      const Function *functions,
+                                      Op ops[static 1]) {
+  const Node *nodes = pr->nodes;
+
+  for (bool changed = true; changed;) {
+    changed = false;
+
+    for (Node_Index i = 0; i < pr->nodes_len; ++i) {
+      if (ops[i] != NT_REDUCE)
+        continue;
+
+      const Bi_Op *body = &nodes[nodes[i].as.bp.rhs].as.bp;
+      for (Node_Index j = body->rhs_lower; j <= body->rhs_upper; ++j) {
+        if (nodes[j].type == NT_BIOP_LET || ops[j] == OP_REDUCE_SERIAL ||
+            (nodes[j].type == NT_APPLY &&
+             !functions[nodes[nodes[j].as.bp.lhs].as.pm.slot].pure)) {
+          ops[i] = OP_REDUCE_SERIAL;
+          changed = true;
+          break;
+        }
+      }
+    }
+  }
+}
+
+//=:interpreter:interpreter
+
+#define G_TYPE Node
+#include "generics/stack.h"
+
+#define G_TYPE Node
+#include "generics/table.h"
+
+typedef struct Profile Profile;
+
+typedef struct Reduce_Worker Reduce_Worker;
+
+typedef struct Memo_Entry Memo_Entry;
+
+// Task_Result - value of a task evaluated by a thread, or its error;
+typedef struct {
+  Node value;
+  ERR status;
+} Task_Result;
+
+#define TASK_NONE (UINT32_MAX)
+
+// Interpreter - executes nodes of a program in scope of a handle;
+typedef struct {
+  const Node *nodes;
+  const Op *ops;
+  const Node_Pos *nodes_pos;
+  Node_Index nodes_len;
+
+  // nodes before exec_len are executed, bodies of reductions follow them;
+  Node_Index exec_len;
+
+  // stack holds at most stack_depth values of program, so values are pushed
+  // without checks of its capacity. Handle keeps stacks of shallow programs
+  // on the C stack and grows a heap one for the others;
+  Node_Index stack_depth;
+  Stack_Node *st;
+
+  // variables are read from slots while executing, global scope is looked up
+  // only to load slots before and store assigned ones after it. The last
+  // slots_temp slots keep values of shared subtrees and are not loaded;
+  const sym_t *slot_syms;
+  Slot slots_len;
+  Slot slots_stored;
+  Slot slots_temp;
+  Slot slots_cap;
+  Node *slots;
+
+  // identifiers of handle, and of the program being evaluated, which may be
+  // compiled by another handle. Symbols of slots of such a program are
+  // translated to foreign_syms;
+  Interner *interner;
+  const Interner *names;
+  sym_t *foreign_syms;
+  Slot foreign_syms_cap;
+
+  Map_Entry_Node *gscope;
+  size_t gscope_len;
+  size_t gscope_cap;
+
+  // tasks of program ordered by nodes, results of the last group evaluated
+  // by threads are kept until its tasks are reached, tasks_forked is the first
+  // task of the group or TASK_NONE;
+  const Task *tasks;
+  Node_Index tasks_len;
+  Node_Index tasks_forked;
+  Node_Index task_results_cap;
+  Task_Result *task_results;
+
+  // alternatives of conditionals ordered by nodes;
+  const Branch *branches;
+  Node_Index branches_len;
+
+  // ranged alternatives of conditionals ordered by nodes, and their bounds;
+  const Range *ranges;
+  Node_Index ranges_len;
+  const Range_Bound *range_bounds;
+
+  // functions of program in order of definitions, calls is depth of calls
+  // being executed. Values of pure functions are cached in memo, entries of
+  // other evaluations than memo_gen are empty;
+  const Function *functions;
+  Node_Index functions_len;
+  unsigned calls;
+  Memo_Entry *memo;
+  uint64_t memo_gen;
+
+  Stats *stats;
+
+  // counters of profiler, NULL when profiling is disabled;
+  Profile *prof;
+
+  // threads of reductions and tasks, the pool is started by the first
+  // reduction large enough to be split or the first group of tasks. Workers
+  // have no pool, so nested reductions and tasks are serial;
+  unsigned threads;
+  Pool *pool;
+  Reduce_Worker *workers;
+} Interpreter;
+
+//=:interpreter:profile
+
+#ifdef NPROFILE
+#define PROFILE_BEGIN(prof, var)
+#define PROFILE_END(ir, var, node, type, fn)
+#else
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+static inline uint64_t prof_cycles(void) { return __rdtsc(); }
+#else
+// nanoseconds are used as cycles, where no cycle counter is available;
+static inline uint64_t prof_cycles(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+typedef struct {
+  uint64_t count;
+  uint64_t cycles;
+} Profile_Counter;
+
+#define G_TYPE Profile_Counter
+#include "generics/table.h"
+
+// Profile - counters of a handle, allocated when profiling is enabled;
+struct Profile {
+  // folded stacks output, per node counters are kept only when not NULL;
+  FILE *folded;
+  Profile_Counter *nodes;
+
+  Profile_Counter types[NT_COUNT];
+  Map_Entry_Profile_Counter builtins[PROFILE_BUILTINS_CAPACITY];
+};
+
+static void prof_add(Interpreter *ir, uint64_t start, Node_Index node, Node_Type type, sym_t fn) {
+  Profile *prof = ir->prof;
+  uint64_t cycles = prof_cycles() - start;
+
+  ++prof->types[type].count;
+  prof->types[type].cycles += cycles;
+
+  if (prof->nodes != NULL) {
+    ++prof->nodes[node].count;
+    prof->nodes[node].cycles += cycles;
+  }
+
+  // functions are counted by symbols of handle;
+  if (type == NT_APPLY && ir->names != ir->interner)
+    fn = intern_translate(ir->interner, ir->names, fn);
+
+  if ((type == NT_CALL || type == NT_REDUCE || type == NT_APPLY) && fn != 0) {
+    Profile_Counter counter = {0};
+    map_get_Profile_Counter(prof->builtins, PROFILE_BUILTINS_CAPACITY, fn, &counter);
+    ++counter.count;
+    counter.cycles += cycles;
+    map_set_Profile_Counter(prof->builtins, PROFILE_BUILTINS_CAPACITY, fn, counter);
+  }
+}
+
+#define PROFILE_BEGIN(prof, var) var = (prof) != NULL ? prof_cycles() : 0
+
+#define PROFILE_END(ir, var, node, type, fn) \
+  do {                                       \
+    if ((ir)->prof != NULL) {                \
+      prof_add(ir, var, node, type, fn);     \
+      fn = 0;                                \
+    }                                        \
+  } while (0)
+
+static int prof_counter_cmp(const void *a, const void *b) {
+  const Profile_Counter *ca = *(const Profile_Counter **)a;
+  const Profile_Counter *cb = *(const Profile_Counter **)b;
+
+  return (ca->cycles < cb->cycles) - (ca->cycles > cb->cycles);
+}
+
+static void prof_print_counter(FILE *file, const char *name, Profile_Counter *counter, uint64_t total) {
+  fprintf(file, "  %-16s %12llu %16llu %6.2f%% %12.1f\n", name,
+      (unsigned long long)counter->count, (unsigned long long)counter->cycles,
+      total ? 100.0 * counter->cycles / total : 0,
+      (double)counter->cycles / counter->count);
+}
+
+// prof_print - prints counters sorted by cycles, functions are named by
+// interner of handle;
+static void prof_print(Profile *prof, const Interner *in, FILE *file) {
+  Profile_Counter *sorted[MAX(NT_COUNT, PROFILE_BUILTINS_CAPACITY)];
+  size_t len = 0;
+  uint64_t total = 0;
+
+  for (Node_Type nt = 0; nt < NT_COUNT; ++nt) {
+    total += prof->types[nt].cycles;
+    if (prof->types[nt].count != 0)
+      sorted[len++] = &prof->types[nt];
+  }
+
+  qsort(sorted, len, sizeof *sorted, prof_counter_cmp);
+
+  fprintf(file, CLR_INF_MSG "PROFILE" CLR_RESET ":\n"
+      "  %-16s %12s %16s %7s %12s\n", "node", "calls", "cycles", "share",
+      "cycles/call");
+  for (size_t i = 0; i < len; ++i)
+    prof_print_counter(file, nt_stringify(sorted[i] - prof->types), sorted[i], total);
+
+  len = 0;
+  for (size_t i = 0; i < PROFILE_BUILTINS_CAPACITY; ++i)
+    if (prof->builtins[i].key != 0)
+      sorted[len++] = &prof->builtins[i].val;
+
+  qsort(sorted, len, sizeof *sorted, prof_counter_cmp);
+
+  fprintf(file, "  %-16s %12s %16s %7s %12s\n", "builtin", "calls",
+      "cycles", "share", "cycles/call");
+  for (size_t i = 0; i < len; ++i) {
+    Map_Entry_Profile_Counter *entry = (Map_Entry_Profile_Counter *)(
+        (char *)sorted[i] - offsetof(Map_Entry_Profile_Counter, val));
+
+    uint32_t name_len;
+    const char *name = intern_name(in, entry->key, &name_len);
+
+    char name_str[SYMBOL_NAME_MAX + 1];
+    snprintf(name_str, sizeof name_str, "%.*s", (int)name_len, name);
+    prof_print_counter(file, name_str, sorted[i], total);
+  }
+}
+
+// prof_reset_functions - drops counters of defined functions, whose symbols
+// are not numbered by a new interner;
+static void prof_reset_functions(Profile *prof) {
+  Map_Entry_Profile_Counter builtins[PROFILE_BUILTINS_CAPACITY] = {0};
+  for (size_t i = 0; i < PROFILE_BUILTINS_CAPACITY; ++i)
+    if (prof->builtins[i].key != 0 && prof->builtins[i].key < BUILTIN_COUNT)
+      map_set_Profile_Counter(builtins, PROFILE_BUILTINS_CAPACITY,
+          prof->builtins[i].key, prof->builtins[i].val);
+
+  memcpy(prof->builtins, builtins, sizeof builtins);
+}
+
+static void prof_print_frame(Interpreter *ir, Node_Index node) {
+  // positions are missing in programs compiled before profiling was enabled;
+  Node_Pos pos = ir->nodes_pos != NULL ? ir->nodes_pos[node] : (Node_Pos){0};
+
+  if ((ir->nodes[node].type == NT_CALL || ir->nodes[node].type == NT_REDUCE ||
+       ir->nodes[node].type == NT_APPLY) &&
+      ir->nodes[ir->nodes[node].as.bp.lhs].type == NT_PRIM_SYM) {
+    uint32_t name_len;
+    const char *name =
+        intern_name(ir->names, ir->nodes[ir->nodes[node].as.bp.lhs].as.pm.s,
+                    &name_len);
+    fprintf(ir->prof->folded, "%.*s()@%u:%u", (int)name_len, name, pos.row,
+        pos.col);
+    return;
+  }
+
+  fprintf(ir->prof->folded, "%s@%u:%u", nt_stringify(ir->nodes[node].type),
+      pos.row, pos.col);
+}
+
+// prof_flush_folded - writes per node counters of the current program as
+// folded stacks (one line per node: root;...;node cycles) and resets them;
+static ERR prof_flush_folded(Interpreter *ir) {
+  Node_Index *parent = malloc(ir->nodes_len * sizeof(Node_Index));
+  if (parent == NULL)
+    return ERR_IR_ALLOC_FAILED;
+
+  for (Node_Index i = 0; i < ir->nodes_len; ++i)
+    parent[i] = i;
+
+  for (Node_Index i = 0; i < ir->nodes_len; ++i) {
+    if (is_unop(ir->nodes[i].type) || ir->nodes[i].type == NT_SAVE ||
+        ir->nodes[i].type == NT_POWI || ir->nodes[i].type == NT_POLY) {
+      parent[ir->nodes[i].as.up.nhs] = i;
+    } else if (ir->nodes[i].type > NT_PRIM_PRB) {
+      parent[ir->nodes[i].as.bp.lhs] = i;
+      parent[ir->nodes[i].as.bp.rhs] = i;
+    }
+  }
+
+  Node_Index frames[PROFILE_MAX_DEPTH];
+
+  for (Node_Index i = 0; i < ir->nodes_len; ++i) {
+    if (ir->prof->nodes[i].count == 0)
+      continue;
+
+    size_t len = 0;
+    Node_Index node = i;
+    for (; len < PROFILE_MAX_DEPTH && parent[node] != node; node = parent[node])
+      frames[len++] = node;
+
+    // frames between root and truncated part are replaced by "...";
+    if (len == PROFILE_MAX_DEPTH) {
+      while (parent[node] != node)
+        node = parent[node];
+      prof_print_frame(ir, node);
+      fputs(";...;", ir->prof->folded);
+    } else {
+      frames[len++] = node;
+    }
+
+    while (len != 0) {
+      prof_print_frame(ir, frames[--len]);
+      fputc(len ? ';' : ' ', ir->prof->folded);
+    }
+
+    fprintf(ir->prof->folded, "%llu\n", (unsigned long long)ir->prof->nodes[i].cycles);
+    ir->prof->nodes[i] = (Profile_Counter){0};
+  }
+
+  free(parent);
+  return ERR_NOERROR;
+}
+#endif
+
+static ERR ir_assert_type(Node_Type expected, Node_Type actual) {
+  if (expected != actual)
+    return ERR_IR_NOT_DEFINED_FOR_TYPE;
+
+  return ERR_NOERROR;
+}
+
+static ERR ir_gscope_set(Interpreter *ir, sym_t sym, Node nd) {
+  PROBE1(gscope__set, sym);
+  return map_set_Node(ir->gscope, ir->gscope_cap, sym, nd);
+}
+
+// ir_slots_reserve - grows slots to at least len, returns ERR_IR_ALLOC_FAILED
+// if out of memory;
+static ERR ir_slots_reserve(Interpreter *ir, Slot len) {
+  if (len <= ir->slots_cap)
+    return ERR_NOERROR;
+
+  Slot cap = MAX(len, ir->slots_cap * 2);
+  Node *slots = realloc(ir->slots, cap * sizeof(Node));
+  if (slots == NULL)
+    return ERR_IR_ALLOC_FAILED;
+
+  STATS_ALLOC(ir->stats, (cap - ir->slots_cap) * sizeof(Node));
+  ir->slots = slots;
+  ir->slots_cap = cap;
+  return ERR_NOERROR;
+}
+
+// ir_slots_translate - numbers variables of program compiled by another
+// handle by symbols of interpreter, returns ERR_IR_ALLOC_FAILED or
+// ERR_IR_SYM_MEMORY_NOT_ENOUGH if out of memory;
+static ERR ir_slots_translate(Interpreter *ir) {
+  Slot len = ir->slots_len - ir->slots_temp;
+  if (len > ir->foreign_syms_cap) {
+    sym_t *syms = realloc(ir->foreign_syms, len * sizeof(sym_t));
+    if (syms == NULL)
+      return ERR_IR_ALLOC_FAILED;
+
+    STATS_ALLOC(ir->stats, (len - ir->foreign_syms_cap) * sizeof(sym_t));
+    ir->foreign_syms = syms;
+    ir->foreign_syms_cap = len;
+  }
+
+  for (Slot i = 0; i < len; ++i) {
+    ir->foreign_syms[i] =
+        intern_translate(ir->interner, ir->names, ir->slot_syms[i]);
+    if (ir->foreign_syms[i] == 0)
+      return ERR_IR_SYM_MEMORY_NOT_ENOUGH;
+  }
+
+  ir->slot_syms = ir->foreign_syms;
+  return ERR_NOERROR;
+}
+
+// ir_st_reserve - grows stack to exactly depth values, unless it holds them
+// already, returns ERR_IR_ALLOC_FAILED if out of memory;
+static ERR ir_st_reserve(Interpreter *ir, Node_Index depth) {
+  size_t cap = ir->st != NULL ? ir->st->cap : 0;
+  if (ir->st != NULL && depth <= cap)
+    return ERR_NOERROR;
+
+  Stack_Node *st = realloc(ir->st, sizeof(Stack_Node) + depth * sizeof(Node));
+  if (st == NULL)
+    return ERR_IR_ALLOC_FAILED;
+
+  STATS_ALLOC(ir->stats, (depth - cap) * sizeof(Node));
+  st->cap = depth;
+  st->len = 0;
+  ir->st = st;
+  return ERR_NOERROR;
+}
+
+// ir_slots_load - reads variables of program from global scope, slots of
+// unbound ones keep their symbols;
+static void ir_slots_load(Interpreter *ir) {
+  for (Slot i = 0; i < ir->slots_len - ir->slots_temp; ++i) {
+    sym_t sym = ir->slot_syms[i];
+    if (map_get_Node(ir->gscope, ir->gscope_cap, sym, &ir->slots[i]) != ERR_NOERROR)
+      ir->slots[i] = (Node){.type = NT_PRIM_SYM, .as.pm = {.s = sym, .slot = i}};
+  }
+}
+
+// ir_slots_store - writes assigned variables back to global scope;
+static ERR ir_slots_store(Interpreter *ir) {
+  for (Slot i = 0; i < ir->slots_stored; ++i)
+    if (ir->slots[i].type != NT_PRIM_SYM)
+      TRY(ERR, ir_gscope_set(ir, ir->slot_syms[i], ir->slots[i]));
+
+  return ERR_NOERROR;
+}
+
+// ir_slot_get - sets *nd to value of variable of symbol node;
+static inline ERR ir_slot_get(Interpreter *ir, Node *nd) {
+  Node *value = &ir->slots[nd->as.pm.slot];
+  if (value->type == NT_PRIM_SYM) {
+    PROBE1(gscope__miss, nd->as.pm.s);
+    return ERR_G_HM_NOT_FOUND;
+  }
+
+  *nd = *value;
+  return ERR_NOERROR;
+}
+
+static ERR ir_st_pop_value(Interpreter *ir, Node *nd) {
+  TRY(ERR, st_pop_Node(ir->st, nd));
+
+  if (nd->type == NT_PRIM_SYM)
+    TRY(ERR, ir_slot_get(ir, nd));
+
+  return ERR_NOERROR;
+}
+
+// ir_nd_yields - reports whether node leaves a value on the stack;
+static bool ir_nd_yields(const Node nodes[static 1], Node_Index node) {
+  while (nodes[node].type == NT_BIOP_XPC)
+    node = nodes[node].as.bp.rhs;
+
+  return nodes[node].type != NT_BIOP_LET && nodes[node].type != NT_DEFINE;
+}
+
+static ERR ir_biop_test_ncmx(Node_Type op, const Node nlhs[static 1],
+                      const Node nrhs[static 1], Node nrt[static 1]) {
+  double ra, rb;
+
+  cmx_t lhs = nlhs->as.pm.c;
+  cmx_t rhs = nrhs->as.pm.c;
+
+  float lhs_re = nlhs->rel_err;
+  float rhs_re = nrhs->rel_err;
+
+  if (cimag(lhs) == 0 && cimag(rhs) == 0) {
+    ra = creal(lhs);
+    rb = creal(rhs);
+  } else if (creal(lhs) == 0 && creal(rhs) == 0) {
+    ra = cimag(lhs);
+    rb = cimag(rhs);
+  } else {
+    return ERR_IR_NOT_DEFINED_FOR_TYPE;
+  }
+
+  double rt;
+
+  switch (op) {
+  case NT_BIOP_GRE: rt = ra > rb; break;
+  case NT_BIOP_LES: rt = ra < rb; break;
+  case NT_BIOP_EQU: rt = contains_interval(ra, lhs_re, rb, rhs_re); break;
+  case NT_BIOP_NEQ: rt = 1 - contains_interval(ra, lhs_re, rb, rhs_re); break;
+  default:
+    return ERR_IR_ILL_NT;
+  }
+
+  *nrt = (Node){.type = NT_PRIM_PRB, .as.pm.c = rt, .rel_err = 0};
+  return ERR_NOERROR;
+}
+
+// ir_biop_ncmx - sets *nrt to binary operator applied to numbers;
+static ERR ir_biop_ncmx(Node_Type op, const Node nlhs[static 1],
+                 const Node nrhs[static 1], Node nrt[static 1]) {
+  cmx_t rt;
+  float rt_re = 0;
+
+  cmx_t lhs = nlhs->as.pm.c;
+  cmx_t rhs = nrhs->as.pm.c;
+
+  float lhs_re = nlhs->rel_err;
+  float rhs_re = nrhs->rel_err;
+
+  switch (op) {
+  case NT_BIOP_ADD:
+    rt = lhs + rhs;
+    rt_re = sqrt(pow(lhs_re * lhs, 2) + pow(rhs_re * rhs, 2)) / fabs(rt);
+    break;
+  case NT_BIOP_SUB:
+    rt = lhs - rhs;
+    rt_re = sqrt(pow(lhs_re * lhs, 2) + pow(rhs_re * rhs, 2)) / fabs(rt);
+    break;
+  case NT_BIOP_APX:
+    rt = lhs;
+    rt_re = rhs / lhs;
+    break;
+  case NT_BIOP_MUL:
+    rt = lhs * rhs;
+    rt_re = sqrt(pow(lhs_re, 2) + pow(rhs_re, 2));
+    break;
+  case NT_BIOP_POW:
+    rt = pow(lhs, rhs);
+    rt_re = sqrt(pow(rhs * lhs_re, 2) + pow(log(lhs) * rhs_re, 2));
+    break;
+  case NT_BIOP_FAC:
+    rt = fac_cmx(lhs, rhs);
+    rt_re = fabs(lhs_re * lhs * log(lhs)) + rhs_re;
+    break;
+  case NT_BIOP_QUO:
+    if (rhs == 0)
+      return ERR_IR_DIV_BY_ZERO;
+
+    rt = lhs / rhs;
+    rt_re = sqrt(pow(lhs_re, 2) + pow(rhs_re, 2));
+    break;
+  case NT_BIOP_MOD:
+    if (cimag(lhs) != 0 || cimag(rhs) != 0)
+      return ERR_IR_NOT_DEFINED_FOR_TYPE;
+
+    rt = fmod(creal(lhs), creal(rhs));
+    rt_re = lhs_re + rhs_re;
+    break;
+  default:
+    return ir_biop_test_ncmx(op, nlhs, nrhs, nrt);
+  }
+
+  *nrt = (Node){.type = NT_PRIM_CMX, .as.pm.c = rt, .rel_err = rt_re};
+  return ERR_NOERROR;
+}
+
+// ir_biop - sets *rt to binary operator applied to values;
+static inline ERR ir_biop(Node_Type op, const Node lhs[static 1],
+                          const Node rhs[static 1], Node rt[static 1]) {
+  if (lhs->type != NT_PRIM_CMX || rhs->type != NT_PRIM_CMX)
+    return ERR_IR_NOT_DEFINED_FOR_TYPE;
+
+  return ir_biop_ncmx(op, lhs, rhs, rt);
+}
+
+// ir_unop - sets *v to unary operator applied to it;
+static inline ERR ir_unop(Node_Type op, Node v[static 1]) {
+  TRY(ERR, ir_assert_type(NT_PRIM_CMX, v->type));
+
+  switch (op) {
+  case NT_UNOP_NOT: v->as.pm.c = subfac_cmx(v->as.pm.c); break;
+  case NT_UNOP_NEG: v->as.pm.c = -v->as.pm.c; break;
+  case NT_UNOP_ABS: v->as.pm.c = fabs(v->as.pm.c); break;
+  default: break;
+  }
+
+  return ERR_NOERROR;
+}
+
+// ir_powi - sets *v to its value raised to power of positive integer n by
+// squaring, its relative error grows n times, as it does for NT_BIOP_POW;
+static inline ERR ir_powi(uint32_t n, Node v[static 1]) {
+  TRY(ERR, ir_assert_type(NT_PRIM_CMX, v->type));
+
+  cmx_t base = v->as.pm.c, rt = base;
+  v->rel_err *= n;
+
+  uint32_t bit = 1u << 31;
+  while ((n & bit) == 0)
+    bit >>= 1;
+
+  // bits of n are taken from the one after the leading one;
+  for (bit >>= 1; bit != 0; bit >>= 1) {
+    rt *= rt;
+    if (n & bit)
+      rt *= base;
+  }
+
+  v->as.pm.c = rt;
+  return ERR_NOERROR;
+}
+
+// ir_poly - sets *v to polynomial of its value given by coefficients from the
+// highest degree. Polynomials of high degree are evaluated by Estrin's
+// scheme, whose products of a level do not wait for each other. Error is
+// the one of sum of terms c*v^k, each of relative error of c and k of v;
+static inline ERR ir_poly(const Node coefs[static 1], uint32_t degree,
+                          Node v[static 1]) {
+  TRY(ERR, ir_assert_type(NT_PRIM_CMX, v->type));
+
+  cmx_t x = v->as.pm.c, rt;
+  bool exact = v->rel_err == 0;
+
+  if (degree < POLY_ESTRIN_MIN) {
+    rt = coefs[0].as.pm.c;
+    for (uint32_t k = 1; k <= degree; ++k)
+      rt = rt * x + coefs[k].as.pm.c;
+  } else {
+    cmx_t level[SIMPLIFY_POW_MAX + 1], p = x;
+    uint32_t n = degree + 1;
+
+    for (uint32_t k = 0; k < n; ++k)
+      level[k] = coefs[degree - k].as.pm.c;
+
+    for (; n > 1; n = (n + 1) / 2, p *= p) {
+      for (uint32_t k = 0; k < n / 2; ++k)
+        level[k] = level[2 * k] + level[2 * k + 1] * p;
+      if (n % 2 != 0)
+        level[n / 2] = level[n - 1];
+    }
+
+    rt = level[0];
+  }
+
+  for (uint32_t k = 0; k <= degree && exact; ++k)
+    exact = coefs[k].rel_err == 0;
+
+  if (!exact) {
+    double err = 0, xk = 1, ax = cabs(x);
+    for (uint32_t k = 0; k <= degree; ++k, xk *= ax) {
+      double t = cabs(coefs[degree - k].as.pm.c) * xk;
+      double re = coefs[degree - k].rel_err, kre = k * (double)v->rel_err;
+      err += t * t * (re * re + kre * kre);
+    }
+    v->rel_err = sqrt(err) / cabs(rt);
+  }
+
+  v->as.pm.c = rt;
+  return ERR_NOERROR;
+}
+
+static ERR ir_call_exec_builtin_cmx(Interpreter *ir, sym_t fn, cmx_t arg) {
+  cmx_t rt;
+
+  switch (fn) {
+  case BUILTIN_SQRT:  rt = sqrt(arg); break;
+  case BUILTIN_CEIL:  rt = ceil(creal(arg)) + ceil(cimag(arg)) * I; break;
+  case BUILTIN_ROUND: rt = round(creal(arg)) + round(cimag(arg)) * I; break;
+  case BUILTIN_FLOOR: rt = floor(creal(arg)) + floor(cimag(arg)) * I; break;
+  case BUILTIN_LN:    rt = log(arg); break;
+  case BUILTIN_EXP:   rt = exp(arg); break;
+  case BUILTIN_COS:   rt = cos(arg); break;
+  case BUILTIN_SIN:   rt = sin(arg); break;
+  case BUILTIN_TAN:   rt = tan(arg); break;
+  case BUILTIN_COSH:  rt = cosh(arg); break;
+  case BUILTIN_SINH:  rt = sinh(arg); break;
+  case BUILTIN_TANH:  rt = tanh(arg); break;
+  case BUILTIN_ACOS:  rt = acos(arg); break;
+  case BUILTIN_ASIN:  rt = asin(arg); break;
+  case BUILTIN_ATAN:  rt = atan(arg); break;
+  case BUILTIN_ACOSH: rt = acosh(arg); break;
+  case BUILTIN_ASINH: rt = asinh(arg); break;
+  case BUILTIN_ATANH: rt = atanh(arg); break;
+  default:
+    return ERR_IR_NOT_DEFINED_FUNCTION;
+  }
+
+  st_put_Node(ir->st, (Node){.type = NT_PRIM_CMX, .as.pm.c = rt, .rel_err = 0});
+  return ERR_NOERROR;
+}
+
+//=:interpreter:bodies
+
+static ERR ir_exec(Interpreter *ir, Node_Index begin, Node_Index end);
+
+// Body - nodes of an argument evaluated by a builtin for values of its
+// variable;
+typedef struct {
+  Slot var;
+  Node_Index lower;
+  Node_Index upper;
+} Body;
+
+// ir_body_eval - evaluates body with its variable bound to x;
+static ERR ir_body_eval(Interpreter *ir, const Body *body, cmx_t x, Node *v) {
+  ir->slots[body->var] = (Node){.type = NT_PRIM_CMX, .as.pm.c = x};
+  TRY(ERR, ir_exec(ir, body->lower, body->upper + 1));
+  TRY(ERR, ir_st_pop_value(ir, v));
+  return ir_assert_type(NT_PRIM_CMX, v->type);
+}
+
+// ir_body_enter - returns binding of variable of body;
+static inline Node ir_body_enter(Interpreter *ir, const Body *body) {
+  return ir->slots[body->var];
+}
+
+// ir_body_leave - restores binding returned by ir_body_enter;
+static inline void ir_body_leave(Interpreter *ir, const Body *body,
+                                 Node saved) {
+  ir->slots[body->var] = saved;
+}
+
+//=:interpreter:numerics
+
+// ir_solve - finds root of real part of body in [a, b] by Brent's method,
+// relative error of root is half of the last bracket;
+static ERR ir_solve(Interpreter *ir, const Body *body, double a, double b,
+             Node *rt) {
+  Node v;
+
+  TRY(ERR, ir_body_eval(ir, body, a, &v));
+  double fa = creal(v.as.pm.c);
+  TRY(ERR, ir_body_eval(ir, body, b, &v));
+  double fb = creal(v.as.pm.c);
+
+  if ((fa > 0 && fb > 0) || (fa < 0 && fb < 0) || isnan(fa) || isnan(fb))
+    return ERR_IR_ROOT_NOT_BRACKETED;
+
+  double c = a, fc = fa, d = b - a, e = d, m = 0;
+
+  for (unsigned i = 0; i < SOLVE_ITERATIONS_MAX && fb != 0; ++i) {
+    if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
+      c = a;
+      fc = fa;
+      d = e = b - a;
+    }
+
+    // b is the best estimate, c is on the other side of root;
+    if (fabs(fc) < fabs(fb)) {
+      a = b, b = c, c = a;
+      fa = fb, fb = fc, fc = fa;
+    }
+
+    double tol = 2 * DBL_EPSILON * fabs(b) + DBL_MIN;
+    m = (c - b) / 2;
+    if (fabs(m) <= tol)
+      break;
+
+    if (fabs(e) < tol || fabs(fa) <= fabs(fb)) {
+      d = e = m;
+    } else {
+      // inverse quadratic interpolation, or secant when a == c;
+      double p, q, s = fb / fa;
+      if (a == c) {
+        p = 2 * m * s;
+        q = 1 - s;
+      } else {
+        double qa = fa / fc, rb = fb / fc;
+        p = s * (2 * m * qa * (qa - rb) - (b - a) * (rb - 1));
+        q = (qa - 1) * (rb - 1) * (s - 1);
+      }
+
+      if (p > 0)
+        q = -q;
+      else
+        p = -p;
+
+      if (2 * p < 3 * m * q - fabs(tol * q) && p < fabs(e * q / 2)) {
+        e = d;
+        d = p / q;
+      } else {
+        d = e = m;
+      }
+    }
+
+    a = b;
+    fa = fb;
+    b += fabs(d) > tol ? d : m > 0 ? tol : -tol;
+
+    TRY(ERR, ir_body_eval(ir, body, b, &v));
+    fb = creal(v.as.pm.c);
+  }
+
+  *rt = (Node){
+      .type = NT_PRIM_CMX,
+      .as.pm.c = b,
+      .rel_err = b != 0 && fb != 0 ? fabs(m) / fabs(b) : 0,
+  };
+  return ERR_NOERROR;
+}
+
+// 15-point Kronrod rule and 7-point Gauss rule embedded in it, abscissae
+// are symmetric, the last one is the middle of interval;
+static const double gk15_nodes[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000,
+};
+
+static const double gk15_kronrod[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714,
+};
+
+// weights of Gauss rule for odd abscissae of Kronrod rule;
+static const double gk15_gauss[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327,
+};
+
+typedef struct {
+  double a;
+  double b;
+  cmx_t value;
+  double err;
+} Quad_Interval;
+
+// ir_gk15 - integrates body over interval. Error is the difference of rules
+// and error of values of body propagated through the rule;
+static ERR ir_gk15(Interpreter *ir, const Body *body, Quad_Interval *in) {
+  double center = (in->a + in->b) / 2, half = (in->b - in->a) / 2;
+  cmx_t values[15];
+  double errs[15];
+  Node v;
+
+  // all nodes of interval are evaluated first, then both rules are applied;
+  for (int i = 0; i < 15; ++i) {
+    double x = i < 8 ? center - half * gk15_nodes[i]
+                     : center + half * gk15_nodes[14 - i];
+    TRY(ERR, ir_body_eval(ir, body, x, &v));
+    values[i] = v.as.pm.c;
+    errs[i] = v.rel_err * cabs(v.as.pm.c);
+  }
+
+  cmx_t kronrod = gk15_kronrod[7] * values[7], gauss = gk15_gauss[3] * values[7];
+  double propagated = gk15_kronrod[7] * errs[7];
+
+  for (int i = 0; i < 7; ++i) {
+    cmx_t pair = values[i] + values[14 - i];
+    kronrod += gk15_kronrod[i] * pair;
+    propagated += gk15_kronrod[i] * (errs[i] + errs[14 - i]);
+    if (i % 2 == 1)
+      gauss += gk15_gauss[i / 2] * pair;
+  }
+
+  in->value = kronrod * half;
+  in->err = (cabs(kronrod - gauss) + propagated) * fabs(half);
+  return ERR_NOERROR;
+}
+
+// ir_integrate - integrates body over [a, b] by adaptive Gauss-Kronrod
+// quadrature, splitting interval of the largest error until estimated error
+// is small enough or INTEGRATE_INTERVALS_MAX intervals are used. Estimated
+// error is the relative error of result;
+static ERR ir_integrate(Interpreter *ir, const Body *body, double a, double b,
+                 Node *rt) {
+  Quad_Interval in[INTEGRATE_INTERVALS_MAX] = {{.a = a, .b = b}};
+  size_t len = 1;
+
+  TRY(ERR, ir_gk15(ir, body, &in[0]));
+
+  cmx_t value = in[0].value;
+  double err = in[0].err;
+
+  while (len < INTEGRATE_INTERVALS_MAX &&
+         err > MAX(INTEGRATE_ABS_TOL, INTEGRATE_REL_TOL * cabs(value))) {
+    size_t worst = 0;
+    for (size_t i = 1; i < len; ++i)
+      if (in[i].err > in[worst].err)
+        worst = i;
+
+    Quad_Interval left = {.a = in[worst].a, .b = (in[worst].a + in[worst].b) / 2};
+    Quad_Interval right = {.a = left.b, .b = in[worst].b};
+
+    // interval is too narrow to be split;
+    if (left.b == left.a || right.b == right.a)
+      break;
+
+    TRY(ERR, ir_gk15(ir, body, &left));
+    TRY(ERR, ir_gk15(ir, body, &right));
+
+    value += left.value + right.value - in[worst].value;
+    err += left.err + right.err - in[worst].err;
+
+    in[worst] = left;
+    in[len++] = right;
+  }
+
+  // sums are recomputed, so updates do not accumulate rounding;
+  value = 0;
+  err = 0;
+  for (size_t i = 0; i < len; ++i) {
+    value += in[i].value;
+    err += in[i].err;
+  }
+
+  *rt = (Node){
+      .type = NT_PRIM_CMX,
+      .as.pm.c = value,
+      .rel_err = value != 0 ? err / cabs(value) : 0,
+  };
+  return ERR_NOERROR;
+}
+
+//=:interpreter:reductions
+
+// Reduce_Partial - reduction of a chunk of range. Sums are compensated by
+// Neumaier's algorithm per component. err is the sum of squares of absolute
+// errors of terms for sums, of relative errors of factors for products and
+// relative error of the extremum for min and max;
+typedef struct {
+  double re, re_c;
+  double im, im_c;
+  double err;
+  ERR status;
+} Reduce_Partial;
+
+typedef struct {
+  sym_t fn;
+  Body body;
+  double from;
+  uint64_t len;
+  uint64_t chunk_len;
+
+  Reduce_Partial *partials;
+  Reduce_Worker *workers;
+
+  // the least failed chunk, chunks after it are skipped;
+  atomic_uint_least64_t failed;
+} Reduce_Job;
+
+struct Reduce_Worker {
+  Interpreter ir;
+  Stats stats;
+};
+
+static inline void reduce_add(double sum[static 1], double c[static 1],
+                              double v) {
+  double t = *sum + v;
+  *c += fabs(*sum) >= fabs(v) ? (*sum - t) + v : (v - t) + *sum;
+  *sum = t;
+}
+
+static inline void reduce_first(sym_t fn, Reduce_Partial *p) {
+  *p = (Reduce_Partial){.re = fn == BUILTIN_PROD};
+}
+
+// reduce_term - accounts value of body, first is set for the first term of
+// a chunk;
+static inline ERR reduce_term(sym_t fn, Reduce_Partial *p, Node v,
+                              bool first) {
+  cmx_t c = v.as.pm.c;
+
+  switch (fn) {
+  case BUILTIN_SUM:
+    reduce_add(&p->re, &p->re_c, creal(c));
+    reduce_add(&p->im, &p->im_c, cimag(c));
+    p->err += pow(v.rel_err * cabs(c), 2);
+    break;
+  case BUILTIN_PROD:
+    c *= CMPLX(p->re, p->im);
+    p->re = creal(c);
+    p->im = cimag(c);
+    p->err += pow(v.rel_err, 2);
+    break;
+  case BUILTIN_MIN:
+  case BUILTIN_MAX:
+    if (cimag(c) != 0)
+      return ERR_IR_NOT_DEFINED_FOR_TYPE;
+
+    if (first || (fn == BUILTIN_MIN ? creal(c) < p->re : creal(c) > p->re)) {
+      p->re = creal(c);
+      p->err = v.rel_err;
+    }
+    break;
+  }
+
+  return ERR_NOERROR;
+}
+
+// reduce_merge - accounts partial of the next chunk, so results do not
+// depend on which thread reduced which chunk;
+static inline void reduce_merge(sym_t fn, Reduce_Partial *p,
+                                const Reduce_Partial *q, bool first) {
+  switch (fn) {
+  case BUILTIN_SUM:
+    reduce_add(&p->re, &p->re_c, q->re);
+    reduce_add(&p->im, &p->im_c, q->im);
+    p->re_c += q->re_c;
+    p->im_c += q->im_c;
+    p->err += q->err;
+    break;
+  case BUILTIN_PROD:
+    reduce_term(fn, p,
+        (Node){.as.pm.c = CMPLX(q->re, q->im), .rel_err = sqrt(q->err)}, false);
+    break;
+  case BUILTIN_MIN:
+  case BUILTIN_MAX:
+    reduce_term(fn, p, (Node){.as.pm.c = q->re, .rel_err = q->err}, first);
+    break;
+  }
+}
+
+static inline Node reduce_result(sym_t fn, const Reduce_Partial *p) {
+  cmx_t c = CMPLX(p->re + p->re_c, p->im + p->im_c);
+  float rel_err;
+
+  switch (fn) {
+  case BUILTIN_SUM:  rel_err = c != 0 ? sqrt(p->err) / cabs(c) : 0; break;
+  case BUILTIN_PROD: rel_err = sqrt(p->err); break;
+  default:           rel_err = p->err; break;
+  }
+
+  return (Node){.type = NT_PRIM_CMX, .as.pm.c = c, .rel_err = rel_err};
+}
+
+// ir_reduce_chunk - evaluates body for every integer of the chunk;
+static ERR ir_reduce_chunk(Interpreter *ir, const Reduce_Job *job, uint64_t chunk,
+                    Reduce_Partial *p) {
+  uint64_t first = chunk * job->chunk_len;
+  uint64_t last = first + job->chunk_len < job->len ? first + job->chunk_len
+                                                    : job->len;
+  Node v;
+
+  reduce_first(job->fn, p);
+
+  for (uint64_t i = first; i < last; ++i) {
+    TRY(ERR, ir_body_eval(ir, &job->body, job->from + (double)i, &v));
+    TRY(ERR, reduce_term(job->fn, p, v, i == first));
+  }
+
+  return ERR_NOERROR;
+}
+
+static void ir_reduce_task(void *ctx, unsigned worker, size_t chunk) {
+  Reduce_Job *job = ctx;
+  Reduce_Partial *p = &job->partials[chunk];
+
+  // chunks before a failed one are still reduced, so the error is the same
+  // as of serial reduction;
+  uint64_t failed = atomic_load_explicit(&job->failed, memory_order_relaxed);
+  if (chunk > failed) {
+    p->status = ERR_NOERROR;
+    return;
+  }
+
+  p->status = ir_reduce_chunk(&job->workers[worker].ir, job, chunk, p);
+  if (p->status == ERR_NOERROR)
+    return;
+
+  while (chunk < failed && !atomic_compare_exchange_weak_explicit(&job->failed,
+             &failed, chunk, memory_order_relaxed, memory_order_relaxed))
+    ;
+}
+
+static void ir_workers_free(Reduce_Worker *workers, unsigned n) {
+  if (workers == NULL)
+    return;
+
+  for (unsigned i = 0; i < n; ++i) {
+    free(workers[i].ir.st);
+    free(workers[i].ir.slots);
+    free(workers[i].ir.memo);
+  }
+  free(workers);
+}
+
+// ir_pool_start - starts threads of reductions, returns false when they are
+// not available;
+static bool ir_pool_start(Interpreter *ir) {
+  if (ir->pool != NULL)
+    return true;
+  if (ir->threads <= 1)
+    return false;
+
+  Pool *pool = pool_new(ir->threads);
+  if (pool == NULL)
+    return false;
+
+  unsigned n = pool_threads(pool);
+  Reduce_Worker *workers = calloc(n, sizeof(Reduce_Worker));
+  if (workers == NULL) {
+    pool_free(pool);
+    return false;
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    Interpreter *w = &workers[i].ir;
+    w->stats = &workers[i].stats;
+    w->threads = 1;
+  }
+
+  STATS_ALLOC(ir->stats, n * sizeof(Reduce_Worker));
+
+  ir->pool = pool;
+  ir->workers = workers;
+  return true;
+}
+
+// ir_workers_prepare - gives workers program of interpreter and copies of its
+// slots;
+static ERR ir_workers_prepare(Interpreter *ir) {
+  for (unsigned i = 0; i < pool_threads(ir->pool); ++i) {
+    Interpreter *w = &ir->workers[i].ir;
+    TRY(ERR, ir_slots_reserve(w, ir->slots_len));
+    TRY(ERR, ir_st_reserve(w, ir->stack_depth));
+
+    w->nodes = ir->nodes;
+    w->ops = ir->ops;
+    w->nodes_len = ir->nodes_len;
+    w->exec_len = ir->exec_len;
+    w->stack_depth = ir->stack_depth;
+    w->tasks = ir->tasks;
+    w->tasks_len = ir->tasks_len;
+    w->tasks_forked = TASK_NONE;
+    w->branches = ir->branches;
+    w->branches_len = ir->branches_len;
+    w->ranges = ir->ranges;
+    w->ranges_len = ir->ranges_len;
+    w->range_bounds = ir->range_bounds;
+    w->functions = ir->functions;
+    w->functions_len = ir->functions_len;
+    w->calls = 0;
+    w->memo_gen = ir->memo_gen;
+    w->st->len = 0;
+    w->slots_len = ir->slots_len;
+    if (ir->slots_len != 0)
+      memcpy(w->slots, ir->slots, ir->slots_len * sizeof(Node));
+  }
+
+  return ERR_NOERROR;
+}
+
+// ir_reduce_parallel - reduces chunks on threads of pool. Workers evaluate
+// body in copies of slots, so assignments made by body are local to them;
+static ERR ir_reduce_parallel(Interpreter *ir, Reduce_Job *job, uint64_t chunks,
+                       Reduce_Partial *rt) {
+  TRY(ERR, ir_workers_prepare(ir));
+
+  job->partials = malloc(chunks * sizeof(Reduce_Partial));
+  if (job->partials == NULL)
+    return ERR_IR_ALLOC_FAILED;
+
+  job->workers = ir->workers;
+  atomic_init(&job->failed, UINT64_MAX);
+
+  pool_run(ir->pool, chunks, ir_reduce_task, job);
+
+  ERR err = ERR_NOERROR;
+  for (uint64_t i = 0; i < chunks && err == ERR_NOERROR; ++i) {
+    err = job->partials[i].status;
+    reduce_merge(job->fn, rt, &job->partials[i], i == 0);
+  }
+
+  free(job->partials);
+  return err;
+}
+
+// ir_reduce_serial - reduces chunks in order in scope of interpreter,
+// variable is restored after it;
+static ERR ir_reduce_serial(Interpreter *ir, Reduce_Job *job, uint64_t chunks,
+                     Reduce_Partial *rt) {
+  Node saved = ir_body_enter(ir, &job->body);
+
+  ERR err = ERR_NOERROR;
+  Reduce_Partial p;
+
+  for (uint64_t i = 0; i < chunks && err == ERR_NOERROR; ++i) {
+    err = ir_reduce_chunk(ir, job, i, &p);
+    reduce_merge(job->fn, rt, &p, i == 0);
+  }
+
+  ir_body_leave(ir, &job->body, saved);
+  return err;
+}
+
+// ir_reduce - applies reduction to the integers of [from, to], or solves or
+// integrates body over it. Arguments are on the stack, body is the rhs of
+// the last argument separator. Range is split into chunks of equal length,
+// which depends only on length of range, and partials of chunks are merged
+// in order, so result is the same for any number of threads. Serial
+// reductions are never split across threads;
+static ERR ir_reduce(Interpreter *ir, Node call, bool serial,
+                     sym_t fn[static 1]) {
+  Node to, from, var, sym;
+
+  TRY(ERR, ir_st_pop_value(ir, &to));
+  TRY(ERR, ir_st_pop_value(ir, &from));
+  TRY(ERR, st_pop_Node(ir->st, &var));
+  TRY(ERR, st_pop_Node(ir->st, &sym));
+
+  TRY(ERR, ir_assert_type(NT_PRIM_CMX, from.type));
+  TRY(ERR, ir_assert_type(NT_PRIM_CMX, to.type));
+  if (cimag(from.as.pm.c) != 0 || cimag(to.as.pm.c) != 0)
+    return ERR_IR_NOT_DEFINED_FOR_TYPE;
+
+  const Bi_Op *args = &ir->nodes[call.as.bp.rhs].as.bp;
+  if (!ir_nd_yields(ir->nodes, args->rhs))
+    return ERR_IR_NUM_ARG_EXPECTED;
+
+  Body body = {
+      .var = var.as.pm.slot,
+      .lower = args->rhs_lower,
+      .upper = args->rhs_upper,
+  };
+
+  *fn = sym.as.pm.s;
+  if (*fn == BUILTIN_SOLVE || *fn == BUILTIN_INTEGRATE) {
+    Node rt, saved = ir_body_enter(ir, &body);
+
+    double a = creal(from.as.pm.c), b = creal(to.as.pm.c);
+    ERR err = *fn == BUILTIN_SOLVE ? ir_solve(ir, &body, a, b, &rt)
+                                   : ir_integrate(ir, &body, a, b, &rt);
+    ir_body_leave(ir, &body, saved);
+    if (err != ERR_NOERROR)
+      return err;
+
+    st_put_Node(ir->st, rt);
+    return ERR_NOERROR;
+  }
+
+  Reduce_Job job = {
+      .fn = *fn,
+      .body = body,
+      .from = ceil(creal(from.as.pm.c)),
+  };
+
+  double len = floor(creal(to.as.pm.c)) - job.from + 1;
+  if (isnan(len))
+    return ERR_IR_NOT_DEFINED_FOR_TYPE;
+
+  // indices are counted exactly by doubles up to 2^53;
+  if (len >= 0x1p53)
+    return ERR_IR_RANGE_TOO_LONG;
+
+  Reduce_Partial rt;
+  reduce_first(job.fn, &rt);
+
+  if (len <= 0) {
+    if (job.fn == BUILTIN_MIN || job.fn == BUILTIN_MAX)
+      return ERR_IR_RANGE_EMPTY;
+    st_put_Node(ir->st, reduce_result(job.fn, &rt));
+    return ERR_NOERROR;
+  }
+
+  job.len = (uint64_t)len;
+  job.chunk_len = (job.len + REDUCE_CHUNKS_MAX - 1) / REDUCE_CHUNKS_MAX;
+  if (job.chunk_len < REDUCE_CHUNK_MIN)
+    job.chunk_len = REDUCE_CHUNK_MIN;
+
+  uint64_t chunks = (job.len + job.chunk_len - 1) / job.chunk_len;
+
+  PROBE2(reduce__entry, job.fn, job.len);
+  ERR err = !serial && job.len >= REDUCE_PARALLEL_MIN && ir_pool_start(ir)
+                ? ir_reduce_parallel(ir, &job, chunks, &rt)
+                : ir_reduce_serial(ir, &job, chunks, &rt);
+  PROBE2(reduce__return, job.fn, err);
+  if (err != ERR_NOERROR)
+    return err;
+
+  st_put_Node(ir->st, reduce_result(job.fn, &rt));
+  return ERR_NOERROR;
+}
+
+//=:interpreter:tasks
+
+typedef struct {
+  const Task *tasks;
+  Task_Result *results;
+  Reduce_Worker *workers;
+} Task_Job;
+
+static void ir_task_run(void *ctx, unsigned worker, size_t task) {
+  Task_Job *job = ctx;
+  Interpreter *w = &job->workers[worker].ir;
+  Task_Result *rt = &job->results[task];
+
+  w->st->len = 0;
+  rt->status = ir_exec(w, job->tasks[task].begin, job->tasks[task].end + 1);
+  if (rt->status == ERR_NOERROR)
+    rt->status = ir_st_pop_value(w, &rt->value);
+}
+
+// ir_task_find - returns task starting at node;
+static inline const Task *ir_task_find(const Interpreter *ir, Node_Index node) {
+  Node_Index lo = 0, hi = ir->tasks_len - 1;
+
+  while (lo < hi) {
+    Node_Index mid = lo + (hi - lo) / 2;
+    if (ir->tasks[mid].begin < node)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return &ir->tasks[lo];
+}
+
+// ir_tasks_fork - evaluates group of tasks starting at task on threads of
+// pool, returns false when they are evaluated serially instead. Nodes between
+// tasks are pure, so slots are not changed until the group is done;
+static bool ir_tasks_fork(Interpreter *ir, Node_Index task) {
+  const Task *group = &ir->tasks[task];
+  ir->tasks_forked = TASK_NONE;
+
+  if (!ir_pool_start(ir) || ir_workers_prepare(ir) != ERR_NOERROR)
+    return false;
+
+  if (group->group_len > ir->task_results_cap) {
+    Task_Result *results = realloc(ir->task_results,
+                                   group->group_len * sizeof(Task_Result));
+    if (results == NULL)
+      return false;
+
+    STATS_ALLOC(ir->stats,
+        (group->group_len - ir->task_results_cap) * sizeof(Task_Result));
+    ir->task_results = results;
+    ir->task_results_cap = group->group_len;
+  }
+
+  Task_Job job = {
+      .tasks = group,
+      .results = ir->task_results,
+      .workers = ir->workers,
+  };
+
+  PROBE1(fork__entry, group->group_len);
+  pool_run(ir->pool, group->group_len, ir_task_run, &job);
+
+  ERR err = ERR_NOERROR;
+  for (Node_Index i = 0; i < group->group_len && err == ERR_NOERROR; ++i)
+    err = ir->task_results[i].status;
+  PROBE2(fork__return, group->group_len, err);
+
+  ir->tasks_forked = task;
+  return true;
+}
+
+//=:interpreter:branches
+
+// ir_branch_find - returns alternative starting at node;
+static inline const Branch *ir_branch_find(const Interpreter *ir,
+                                           Node_Index node) {
+  Node_Index lo = 0, hi = ir->branches_len - 1;
+
+  while (lo < hi) {
+    Node_Index mid = lo + (hi - lo) / 2;
+    if (ir->branches[mid].begin < node)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return &ir->branches[lo];
+}
+
+//=:interpreter:ranges
+
+// ir_range_find - returns ranged alternatives of conditional starting at node;
+static inline const Range *ir_range_find(const Interpreter *ir,
+                                         Node_Index node) {
+  Node_Index lo = 0, hi = ir->ranges_len - 1;
+
+  while (lo < hi) {
+    Node_Index mid = lo + (hi - lo) / 2;
+    if (ir->ranges[mid].begin < node)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return &ir->ranges[lo];
+}
+
+// ir_range_take - returns the first alternative of range, test of which holds
+// for x, or len of range, when none does;
+static inline Node_Index ir_range_take(const Interpreter *ir,
+                                       const Range *range, double x) {
+  const Range_Bound *bounds = &ir->range_bounds[range->bounds];
+  Node_Index lo = 0, hi = range->len;
+
+  while (lo < hi) {
+    Node_Index mid = lo + (hi - lo) / 2;
+    if (range->type == NT_BIOP_LES ? x < bounds[mid].bound
+                                   : x > bounds[mid].bound)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  return lo;
+}
+
+//=:interpreter:functions
+
+struct Memo_Entry {
+  uint64_t gen;
+  Node_Index fn;
+  Node args[FUNCTION_MEMO_ARGS_MAX];
+  Node value;
+};
+
+// memo_index - returns entry of arguments of function fn;
+static inline size_t memo_index(Node_Index fn, const Node args[static 1],
+                                uint32_t len) {
+  uint64_t hash = share_mix(0xcbf29ce484222325, fn), bits[2];
+
+  for (uint32_t i = 0; i < len; ++i) {
+    memcpy(bits, &args[i].as.pm.c, sizeof bits);
+    hash = share_mix(share_mix(share_mix(hash, args[i].type), bits[0]),
+        bits[1]);
+  }
+
+  return hash & (FUNCTION_MEMO_CAPACITY - 1);
+}
+
+// memo_same - reports whether arguments are the same values of the same
+// errors, literals of different signs of zero are not;
+static inline bool memo_same(const Node a[static 1], const Node b[static 1],
+                             uint32_t len) {
+  for (uint32_t i = 0; i < len; ++i)
+    if (a[i].type != b[i].type || a[i].rel_err != b[i].rel_err ||
+        memcmp(&a[i].as.pm.c, &b[i].as.pm.c, sizeof(cmx_t)) != 0)
+      return false;
+
+  return true;
+}
+
+// ir_memo_entry - returns entry of memo for arguments of pure function fn,
+// or NULL when they are not cached. Memo is allocated by the first pure call;
+static inline Memo_Entry *ir_memo_entry(Interpreter *ir, Node_Index fn,
+                                        const Node args[static 1],
+                                        uint32_t len) {
+  if (!ir->functions[fn].pure || len > FUNCTION_MEMO_ARGS_MAX)
+    return NULL;
+
+  if (ir->memo == NULL) {
+    ir->memo = calloc(FUNCTION_MEMO_CAPACITY, sizeof(Memo_Entry));
+    if (ir->memo == NULL)
+      return NULL;
+    STATS_ALLOC(ir->stats, FUNCTION_MEMO_CAPACITY * sizeof(Memo_Entry));
+  }
+
+  return &ir->memo[memo_index(fn, args, len)];
+}
+
+// ir_apply - calls function of call node with arguments on the stack.
+// Parameters are bound to arguments in their slots, which are restored after
+// the body, so outer calls of the same function keep their bindings;
+static ERR ir_apply(Interpreter *ir, Node call, sym_t fn[static 1]) {
+  Node_Index index = ir->nodes[call.as.bp.lhs].as.pm.slot;
+  const Function *f = &ir->functions[index];
+  Node args[f->params_len], frame[f->params_len], sym;
+
+  for (uint32_t i = f->params_len; i-- > 0;)
+    TRY(ERR, ir_st_pop_value(ir, &args[i]));
+  TRY(ERR, st_pop_Node(ir->st, &sym));
+  *fn = sym.as.pm.s;
+
+  Memo_Entry *entry = ir_memo_entry(ir, index, args, f->params_len);
+  if (entry != NULL && entry->gen == ir->memo_gen && entry->fn == index &&
+      memo_same(entry->args, args, f->params_len)) {
+    st_put_Node(ir->st, entry->value);
+    return ERR_NOERROR;
+  }
+
+  if (ir->calls == FUNCTION_DEPTH_MAX)
+    return ERR_IR_CALLS_TOO_DEEP;
+
+  Node *params = &ir->slots[f->params];
+  memcpy(frame, params, f->params_len * sizeof(Node));
+  memcpy(params, args, f->params_len * sizeof(Node));
+
+  ++ir->calls;
+  ERR err = ir_exec(ir, f->begin, f->end);
+  --ir->calls;
+
+  memcpy(params, frame, f->params_len * sizeof(Node));
+  if (err != ERR_NOERROR)
+    return err;
+
+  if (entry != NULL) {
+    *entry = (Memo_Entry){
+        .gen = ir->memo_gen,
+        .fn = index,
+        .value = ir->st->data[ir->st->len - 1],
+    };
+    memcpy(entry->args, args, f->params_len * sizeof(Node));
+  }
+
+  return ERR_NOERROR;
+}
+
+//=:interpreter:exec
+
+// ir_exec - executes nodes [begin, end). Operations are dispatched by
+// computed goto, every operation jumps to the next one itself, so each has
+// its own indirect branch instead of sharing one of a switch;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#pragma GCC diagnostic ignored "-Woverride-init"
+static ERR ir_exec(Interpreter *ir, Node_Index begin, Node_Index end) {
+  static const void *const dispatch[OP_COUNT] = {
+      [0 ... OP_COUNT - 1] = &&op_not_implemented,
+      [NT_PRIM_SYM] = &&op_push,
+      [NT_PRIM_CMX] = &&op_push,
+      [NT_BIOP_LET] = &&op_let,
+      [NT_BIOP_GRE ... NT_BIOP_POW] = &&op_biop,
+      [NT_BIOP_FAC] = &&op_biop,
+      [NT_BIOP_XPC] = &&op_xpc,
+      [NT_BIOP_SEP] = &&op_sep,
+      [NT_UNOP_ABS ... NT_UNOP_NEG] = &&op_unop,
+      [NT_CALL] = &&op_call,
+      [NT_REDUCE] = &&op_reduce,
+      [OP_REDUCE_SERIAL] = &&op_reduce_serial,
+      [NT_SAVE] = &&op_save,
+      [NT_POWI] = &&op_powi,
+      [NT_POLY] = &&op_poly,
+      [NT_BIOP_SPZ] = &&op_spz,
+      [NT_ELSE] = &&op_else,
+      [NT_APPLY] = &&op_apply,
+      [OP_LOAD] = &&op_load,
+      [OP_CMX_BIOP] = &&op_cmx_biop,
+      [OP_LOAD_BIOP] = &&op_load_biop,
+      [OP_BIOP_BIOP] = &&op_biop_biop,
+      [OP_UNOP_BIOP] = &&op_unop_biop,
+      [OP_TASK] = &&op_task,
+      [OP_BRANCH] = &&op_branch,
+      [OP_RANGE] = &&op_range,
+  };
+
+  const Node *nodes = ir->nodes;
+  const Op *ops = ir->ops;
+  Stack_Node *st = ir->st;
+
+  ERR ierr;
+  Node current, lhs, rhs;
+  Node_Index pc = begin, task, taken;
+  const Branch *branch;
+  const Range *range;
+
+  [[maybe_unused]] sym_t fn = 0;
+#ifndef NPROFILE
+  uint64_t start = 0;
+#endif
+
+// IR_NEXT - finishes operation of n nodes and jumps to the next one, fused
+// operations are accounted to their last node;
+#define IR_NEXT(n)                                                   \
+  {                                                                  \
+    PROFILE_END(ir, start, pc, nodes[pc + (n) - 1].type, fn);        \
+    pc += n;                                                         \
+    goto next;                                                       \
+  }
+
+// IR_JUMP - finishes operation and executes op for node target;
+#define IR_JUMP(target, op)                                          \
+  {                                                                  \
+    PROFILE_END(ir, start, pc, nodes[pc].type, fn);                  \
+    pc = target;                                                     \
+    PROFILE_BEGIN(ir->prof, start);                                  \
+    goto *dispatch[op];                                              \
+  }
+
+next:
+  if (pc >= end)
+    goto done;
+  PROFILE_BEGIN(ir->prof, start);
+  goto *dispatch[ops[pc]];
+
+op_push:
+  st_put_Node(st, nodes[pc]);
+  IR_NEXT(1);
+
+op_load:
+  current = nodes[pc];
+  TRY(ERR, ir_slot_get(ir, &current));
+  st_put_Node(st, current);
+  IR_NEXT(1);
+
+op_unop:
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_unop(nodes[pc].type, &lhs));
+  st_put_Node(st, lhs);
+  IR_NEXT(1);
+
+op_powi:
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_powi(nodes[pc].as.up.exp, &lhs));
+  st_put_Node(st, lhs);
+  IR_NEXT(1);
+
+op_poly:
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_poly(&nodes[nodes[pc].as.up.poly.coefs],
+                   nodes[pc].as.up.poly.degree, &lhs));
+  st_put_Node(st, lhs);
+  IR_NEXT(1);
+
+op_biop:
+  TRY(ERR, ir_st_pop_value(ir, &rhs));
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_biop(nodes[pc].type, &lhs, &rhs, &current));
+  st_put_Node(st, current);
+  IR_NEXT(1);
+
+op_cmx_biop:
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_biop(nodes[pc + 1].type, &lhs, &nodes[pc], &current));
+  st_put_Node(st, current);
+  IR_NEXT(2);
+
+op_load_biop:
+  rhs = nodes[pc];
+  TRY(ERR, ir_slot_get(ir, &rhs));
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_biop(nodes[pc + 1].type, &lhs, &rhs, &current));
+  st_put_Node(st, current);
+  IR_NEXT(2);
+
+op_biop_biop:
+  TRY(ERR, ir_st_pop_value(ir, &rhs));
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_biop(nodes[pc].type, &lhs, &rhs, &rhs));
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_biop(nodes[pc + 1].type, &lhs, &rhs, &current));
+  st_put_Node(st, current);
+  IR_NEXT(2);
+
+op_unop_biop:
+  TRY(ERR, ir_st_pop_value(ir, &rhs));
+  TRY(ERR, ir_unop(nodes[pc].type, &rhs));
+  TRY(ERR, ir_st_pop_value(ir, &lhs));
+  TRY(ERR, ir_biop(nodes[pc + 1].type, &lhs, &rhs, &current));
+  st_put_Node(st, current);
+  IR_NEXT(2);
+
+op_task:
+  // tasks of a group are reached in order, the first one evaluates all of
+  // them, when threads are available;
+  task = ir_task_find(ir, pc) - ir->tasks;
+  if (ir->tasks[task].group_len != 0)
+    ir_tasks_fork(ir, task);
+
+  if (ir->tasks_forked == TASK_NONE || task < ir->tasks_forked ||
+      task >= ir->tasks_forked + ir->tasks[ir->tasks_forked].group_len)
+    goto *dispatch[ir->tasks[task].op];
+
+  TRY(ERR, ir->task_results[task - ir->tasks_forked].status);
+  st_put_Node(st, ir->task_results[task - ir->tasks_forked].value);
+  IR_NEXT(ir->tasks[task].end + 1 - pc);
+
+op_branch:
+  // test of alternative is on the stack, a failed one jumps over its nodes;
+  branch = ir_branch_find(ir, pc);
+  TRY(ERR, ir_st_pop_value(ir, &current));
+  TRY(ERR, ir_assert_type(NT_PRIM_PRB, current.type));
+
+  if (creal(current.as.pm.c) != 0)
+    goto *dispatch[branch->op];
+  if (branch->miss == 0)
+    return ERR_IR_NO_ALTERNATIVE;
+  IR_NEXT(branch->miss - pc);
+
+op_range:
+  // tests of other than real variable are evaluated to report their errors;
+  range = ir_range_find(ir, pc);
+  current = ir->slots[nodes[pc].as.pm.slot];
+  if (current.type != NT_PRIM_CMX || cimag(current.as.pm.c) != 0)
+    goto *dispatch[range->op];
+
+  taken = ir_range_take(ir, range, creal(current.as.pm.c));
+  if (taken < range->len)
+    IR_JUMP(ir->range_bounds[range->bounds + taken].begin,
+            ir->range_bounds[range->bounds + taken].op);
+  if (range->miss == 0)
+    return ERR_IR_NO_ALTERNATIVE;
+  IR_NEXT(range->miss - pc);
+
+op_spz:
+  // value of taken alternative is on the stack, the others are skipped;
+  IR_NEXT(ir_branch_find(ir, nodes[pc].as.bp.rhs_lower)->done - pc);
+
+op_else:
+  // value of the next alternative is on the stack;
+  IR_NEXT(1);
+
+op_call:
+  // arguments of calls other than reductions are not supported;
+  if (nodes[nodes[pc].as.bp.rhs].type == NT_BIOP_SEP)
+    return ERR_IR_NUM_ARG_EXPECTED;
+
+  TRY(ERR, ir_st_pop_value(ir, &rhs));
+  TRY(ERR, st_pop_Node(st, &lhs));
+
+  TRY(ERR, ir_assert_type(NT_PRIM_SYM, lhs.type));
+  TRY(ERR, ir_assert_type(NT_PRIM_CMX, rhs.type));
+  fn = lhs.as.pm.s;
+
+  PROBE1(builtin__entry, fn);
+  ierr = ir_call_exec_builtin_cmx(ir, fn, rhs.as.pm.c);
+  PROBE2(builtin__return, fn, ierr);
+  if (ierr != ERR_NOERROR)
+    return ierr;
+  IR_NEXT(1);
+
+op_reduce:
+  TRY(ERR, ir_reduce(ir, nodes[pc], false, &fn));
+  IR_NEXT(1);
+
+op_reduce_serial:
+  TRY(ERR, ir_reduce(ir, nodes[pc], true, &fn));
+  IR_NEXT(1);
+
+op_apply:
+  TRY(ERR, ir_apply(ir, nodes[pc], &fn));
+  IR_NEXT(1);
+
+op_sep:
+  // arguments are left on the stack for the reduction;
+  IR_NEXT(1);
+
+op_save:
+  // value of shared subtree is left on the stack for its parent;
+  TRY(ERR, ir_st_pop_value(ir, &current));
+  ir->slots[nodes[pc].as.up.slot] = current;
+  st_put_Node(st, current);
+  IR_NEXT(1);
+
+op_let:
+  TRY(ERR, ir_st_pop_value(ir, &rhs));
+  TRY(ERR, st_pop_Node(st, &lhs));
+
+  TRY(ERR, ir_assert_type(NT_PRIM_SYM, lhs.type));
+
+  PROBE1(gscope__set, lhs.as.pm.s);
+  ir->slots[lhs.as.pm.slot] = rhs;
+  IR_NEXT(1);
+
+op_xpc:
+  current = nodes[pc];
+  if (ir_nd_yields(nodes, current.as.bp.rhs))
+    TRY(ERR, st_pop_Node(st, &rhs));
+  if (ir_nd_yields(nodes, current.as.bp.lhs))
+    TRY(ERR, st_pop_Node(st, &lhs));
+  if (ir_nd_yields(nodes, current.as.bp.rhs))
+    st_put_Node(st, rhs);
+  IR_NEXT(1);
+
+op_not_implemented:
+  return ERR_IR_NOT_IMPLEMENTED;
+
+#undef IR_NEXT
+#undef IR_JUMP
+
+done:
+  if (st->len) {
+    TRY(ERR, ir_st_pop_value(ir, &current));
+    st_put_Node(st, current);
+  }
+
+  return ERR_NOERROR;
+}
+#pragma GCC diagnostic pop
+
+// ir_exec_instrumented - same as ir_exec, but accounts statistics and writes
+// folded stacks of profiler. Free values of the stack are marked before
+// execution, so its high-water mark is found by the first one left marked
+// instead of by every operation;
+static ERR ir_exec_instrumented(Interpreter *ir) {
+#ifndef NSTATS
+  if (ir->stats->enabled)
+    for (size_t i = ir->st->len; i < ir->st->cap; ++i)
+      ir->st->data[i] = (Node){.type = NT_COUNT};
+#endif
+
+  STATS_CLOCK_BEGIN(ir->stats, wall, CLOCK_MONOTONIC);
+  STATS_CLOCK_BEGIN(ir->stats, cpu, CLOCK_PROCESS_CPUTIME_ID);
+  PROBE1(exec__entry, ir->nodes_len);
+  ERR err = ir_exec(ir, 0, ir->exec_len);
+  PROBE2(exec__return, err, ir->st->len);
+  STATS_CLOCK_END(ir->stats, cpu, CLOCK_PROCESS_CPUTIME_ID, exec_cpu_ns);
+  STATS_CLOCK_END(ir->stats, wall, CLOCK_MONOTONIC, wall_ns[SP_EXEC]);
+
+#ifndef NSTATS
+  if (ir->stats->enabled) {
+    size_t hwm = ir->st->cap;
+    while (hwm > 0 && ir->st->data[hwm - 1].type == NT_COUNT)
+      --hwm;
+    STATS_MAX(ir->stats, st_hwm, hwm);
+  }
+#endif
+
+#ifndef NPROFILE
+  if (ir->prof != NULL && ir->prof->folded != NULL) {
+    ERR ferr = prof_flush_folded(ir);
+    if (err == ERR_NOERROR)
+      err = ferr;
+  }
+#endif
+
+  return err;
+}
+
+//=:interpreter:stats
+
+#ifndef NSTATS
+static void stats_print(Interpreter *ir, FILE *file) {
+  Stats *stats = ir->stats;
+  size_t occupied = 0, dist_max = 0, dist_sum = 0;
+
+  for (size_t i = 0; i < ir->gscope_cap; ++i) {
+    size_t dist = map_dist_Node(ir->gscope, ir->gscope_cap, i);
+    occupied += dist != 0;
+    dist_sum += dist;
+    dist_max = MAX(dist_max, dist);
+  }
+
+  double dist_mean = occupied ? (double)dist_sum / occupied : 0;
+
+  long rss_kib = 0;
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == 0)
+    rss_kib = ru.ru_maxrss;
+#ifdef __APPLE__
+  rss_kib /= 1024;
+#endif
+#endif
+
+  // exclusive wall time of every phase;
+  double read = stats->wall_ns[SP_READ] / 1e9;
+  double lex = (stats->wall_ns[SP_LEX] - stats->wall_ns[SP_READ]) / 1e9;
+  double parse = (stats->wall_ns[SP_PARSE] - stats->wall_ns[SP_LEX]) / 1e9;
+  double exec = stats->wall_ns[SP_EXEC] / 1e9;
+
+  if (stats->json) {
+    fprintf(file,
+        "{\"wall\":{\"read\":%.9f,\"lex\":%.9f,\"parse\":%.9f,\"exec\":%.9f},"
+        "\"cpu\":{\"front\":%.9f,\"exec\":%.9f},"
+        "\"tokens\":%llu,\"nodes\":%llu,"
+        "\"rules\":{\"identity\":%llu,\"negation\":%llu,\"reciprocal\":%llu,"
+        "\"power\":%llu,\"polynomial\":%llu},\"stack_hwm\":%zu,\"stack_depth\":%zu,"
+        "\"gscope\":{\"len\":%zu,\"cap\":%zu,\"probe_max\":%zu,\"probe_mean\":%.3f},"
+        "\"rss_kib\":%ld,\"allocs\":%llu,\"alloc_bytes\":%llu}\n",
+        read, lex, parse, exec, stats->front_cpu_ns / 1e9,
+        stats->exec_cpu_ns / 1e9, (unsigned long long)stats->tokens,
+        (unsigned long long)stats->nodes,
+        (unsigned long long)stats->rules[SR_IDENTITY],
+        (unsigned long long)stats->rules[SR_NEGATION],
+        (unsigned long long)stats->rules[SR_RECIPROCAL],
+        (unsigned long long)stats->rules[SR_POWER],
+        (unsigned long long)stats->rules[SR_POLY], stats->st_hwm, stats->st_depth,
+        occupied, ir->gscope_cap, dist_max, dist_mean, rss_kib,
+        (unsigned long long)stats->allocs,
+        (unsigned long long)stats->alloc_bytes);
+    return;
+  }
+
+  fprintf(file,
+      CLR_INF_MSG "STATS" CLR_RESET ":\n"
+      "  wall:   read %.6fs, lex %.6fs, parse %.6fs, exec %.6fs\n"
+      "  cpu:    front-end %.6fs, exec %.6fs\n"
+      "  nodes:  %llu (%llu tokens)\n"
+      "  rules:  identity %llu, negation %llu, reciprocal %llu, power %llu,\n"
+      "          polynomial %llu\n"
+      "  stack:  high-water %zu of depth %zu\n"
+      "  gscope: %zu of %zu, probe length max %zu, mean %.3f\n"
+      "  memory: peak RSS %ld KiB, %llu allocations of %llu bytes\n",
+      read, lex, parse, exec, stats->front_cpu_ns / 1e9,
+      stats->exec_cpu_ns / 1e9, (unsigned long long)stats->nodes,
+      (unsigned long long)stats->tokens,
+      (unsigned long long)stats->rules[SR_IDENTITY],
+      (unsigned long long)stats->rules[SR_NEGATION],
+      (unsigned long long)stats->rules[SR_RECIPROCAL],
+      (unsigned long long)stats->rules[SR_POWER],
+      (unsigned long long)stats->rules[SR_POLY], stats->st_hwm, stats->st_depth,
+      occupied,
+      ir->gscope_cap, dist_max, dist_mean, rss_kib,
+      (unsigned long long)stats->allocs, (unsigned long long)stats->alloc_bytes);
+}
+#endif
+
+
+//=:api:handle
+
+struct Mewa {
+  Interpreter ir;
+  Parser *pr;
+
+  // page of reader of files, allocated on first use;
+  char *page;
+
+  Stats stats;
+  Mewa_Error error;
+};
+
+struct Mewa_Program {
+  Node_Index root;
+  Node_Index nodes_len;
+  Node_Index exec_len;
+
+  // max number of values on the stack while program is executed;
+  Node_Index stack_depth;
+
+  // operations of nodes;
+  Op *ops;
+
+  // subtrees evaluated by threads of their own, ordered by nodes;
+  Task *tasks;
+  Node_Index tasks_len;
+
+  // alternatives of conditionals, ordered by nodes;
+  Branch *branches;
+  Node_Index branches_len;
+
+  // ranged alternatives of conditionals, ordered by nodes, and their bounds;
+  Range *ranges;
+  Node_Index ranges_len;
+  Range_Bound *range_bounds;
+
+  // functions defined by program or called by it, in order of definitions;
+  Function *functions;
+  Node_Index functions_len;
+
+  // symbols of slots of variables, assigned ones come first, slots of
+  // parameters and temporary slots of shared subtrees follow them and have no
+  // symbols;
+  sym_t *slot_syms;
+  Slot slots_len;
+  Slot slots_stored;
+  Slot slots_temp;
+
+  // source positions of nodes, kept only for profiling of nodes;
+  Node_Pos *nodes_pos;
+  Node *nodes;
+
+  // interner of handle which compiled program, symbols of nodes are its own;
+  Interner *interner;
+};
+
+// ir_gscope_builtins - binds builtin constants in empty global scope;
+static void ir_gscope_builtins(Interpreter *ir) {
+  map_set_Node(ir->gscope,
+      ir->gscope_cap,
+      BUILTIN_CONST_PI,
+      (Node){
+          .type = NT_PRIM_CMX,
+          .as.pm.c = M_PI,
+          .rel_err = (nextafter((double)M_PI, INFINITY) - M_PI) / M_PI,
+      });
+  map_set_Node(ir->gscope,
+      ir->gscope_cap,
+      BUILTIN_CONST_E,
+      (Node){
+          .type = NT_PRIM_CMX,
+          .as.pm.c = M_E,
+          .rel_err = (nextafter((double)M_E, INFINITY) - M_E) / M_E,
+      });
+}
+
+static int mewa_fail(Mewa *m, ERR err) {
+  m->error = (Mewa_Error){.code = err};
+  return err;
+}
+
+MEWA_API Mewa *mewa_new(void) {
+  Mewa *m = calloc(1, sizeof(Mewa));
+  if (m == NULL)
+    return NULL;
+
+  // parser is freed by mewa_free even if the handle fails to be created;
+  m->pr = calloc(1, sizeof(Parser));
+  m->ir.gscope_cap = GLOBAL_SCOPE_CAPACITY;
+  m->ir.gscope = calloc(m->ir.gscope_cap, sizeof(Map_Entry_Node));
+  m->ir.interner = intern_new();
+
+  if (m->pr == NULL || m->ir.gscope == NULL || m->ir.interner == NULL) {
+    mewa_free(m);
+    return NULL;
+  }
+
+  STATS_ALLOC(&m->stats, sizeof(Mewa));
+  STATS_ALLOC(&m->stats, sizeof(Parser));
+  STATS_ALLOC(&m->stats, m->ir.gscope_cap * sizeof(Map_Entry_Node));
+
+  m->ir.stats = &m->stats;
+  m->ir.names = m->ir.interner;
+  unsigned cpus = pool_cpus();
+  m->ir.threads = MIN(cpus, REDUCE_THREADS_MAX);
+
+  *m->pr = (Parser){
+      .lx.rd.stats = &m->stats,
+      .lx.interner = m->ir.interner,
+      .nodes_len = 1,
+      .nodes_cap = NODE_BUF_SIZE,
+  };
+
+  ir_gscope_builtins(&m->ir);
+  return m;
+}
+
+MEWA_API void mewa_reset(Mewa *m) {
+  memset(m->ir.gscope, 0, m->ir.gscope_cap * sizeof(Map_Entry_Node));
+  ir_gscope_builtins(&m->ir);
+
+  defs_free(m->pr->defs, m->pr->defs_len);
+  m->pr->defs = NULL;
+  m->pr->defs_len = 0;
+  m->pr->defs_cap = 0;
+
+  // names bound by the handle are dropped with a new interner, programs keep
+  // the old one alive as long as they need it. Counters of defined functions
+  // are keyed by old symbols, so only builtins keep theirs;
+  Interner *in = intern_new();
+  if (in != NULL) {
+    intern_unref(m->ir.interner);
+    m->ir.interner = in;
+    m->ir.names = in;
+    m->pr->lx.interner = in;
+
+#ifndef NPROFILE
+    if (m->ir.prof != NULL)
+      prof_reset_functions(m->ir.prof);
+#endif
+  }
+
+  m->error = (Mewa_Error){0};
+}
+
+MEWA_API void mewa_free(Mewa *m) {
+  if (m == NULL)
+    return;
+
+  if (m->pr != NULL) {
+    free(m->pr->frames);
+    free(m->pr->nodes_pos);
+    free(m->pr->nodes);
+    defs_free(m->pr->defs, m->pr->defs_len);
+  }
+
+#ifndef NPROFILE
+  if (m->ir.prof != NULL)
+    free(m->ir.prof->nodes);
+#endif
+
+  if (m->ir.pool != NULL) {
+    ir_workers_free(m->ir.workers, pool_threads(m->ir.pool));
+    pool_free(m->ir.pool);
+  }
+
+  free(m->ir.prof);
+  free(m->ir.task_results);
+  free(m->ir.memo);
+  free(m->ir.slots);
+  free(m->ir.gscope);
+  free(m->ir.st);
+  free(m->ir.foreign_syms);
+  intern_unref(m->ir.interner);
+  free(m->pr);
+  free(m->page);
+  free(m);
+}
+
+MEWA_API void mewa_threads(Mewa *m, unsigned threads) {
+  if (m->ir.pool != NULL) {
+    ir_workers_free(m->ir.workers, pool_threads(m->ir.pool));
+    pool_free(m->ir.pool);
+    m->ir.pool = NULL;
+    m->ir.workers = NULL;
+  }
+
+  if (threads == 0)
+    threads = pool_cpus();
+  m->ir.threads = MIN(threads, REDUCE_THREADS_MAX);
+}
+
+//=:api:program
+
+// mewa_compile_reader - parses input of reader of parser into a program;
+static int mewa_compile_reader(Mewa *m, Mewa_Program **program) {
+  Parser *pr = m->pr;
+  Node_Index root = 0, exec_len = 0;
+
+  if (pr->nodes == NULL) {
+    pr->nodes = malloc(NODE_BUF_SIZE * sizeof(Node));
+    if (pr->nodes == NULL)
+      return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+    STATS_ALLOC(&m->stats, NODE_BUF_SIZE * sizeof(Node));
+  }
+
+  rd_reset_counters(&pr->lx.rd);
+  pr->p0c = 0;
+  pr->abs = false;
+  pr->nodes_len = 1;
+
+  sym_t *slot_syms = NULL;
+  Slot slots_len = 0, slots_stored = 0, slots_temp = 0, params = 0;
+
+  Definition *defs = NULL;
+  Node_Index defs_len = 0;
+
+  ERR err = pr_next_node_instrumented(pr, &root);
+  if (pr->lx.rd.failed)
+    err = ERR_RD_READ_FAILED;
+  else if (err == ERR_NOERROR && pr->lx.tt != TT_EOS)
+    err = ERR_PR_UNEXPECTED_EXPRESSION;
+  else if (err == ERR_NOERROR)
+    err = pr_postfix_unops(pr, &root);
+
+  if (err == ERR_NOERROR)
+    err = pr_link_functions(pr, &root, &defs, &defs_len);
+
+  if (err == ERR_NOERROR) {
+    pr_lower_branches(pr);
+    err = pr_lower_reductions(pr, &root, &exec_len);
+  }
+
+  if (err == ERR_NOERROR)
+    err = pr_lower_functions(pr, &root, &exec_len);
+
+  if (err == ERR_NOERROR)
+    err = pr_simplify(pr, &root, &exec_len);
+
+  if (err == ERR_NOERROR)
+    err = pr_fold_polys(pr, &root, &exec_len);
+
+  // parameters are bound after folding, which tells variables by symbols;
+  if (err == ERR_NOERROR) {
+    pr_bind_params(pr, exec_len, &params);
+    err = pr_resolve_slots(pr, params, &slot_syms, &slots_len, &slots_stored);
+  }
+
+  slots_temp = params;
+  if (err == ERR_NOERROR)
+    err = pr_share_subtrees(pr, &root, &exec_len, &slots_len, &slots_temp);
+
+  Op *ops = NULL;
+  if (err == ERR_NOERROR) {
+    ops = malloc(pr->nodes_len * sizeof(Op));
+    err = ops != NULL ? pr_compile_ops(pr, exec_len, ops) : ERR_IR_ALLOC_FAILED;
+  }
+
+  Task *tasks = NULL;
+  Node_Index tasks_len = 0;
+  if (err == ERR_NOERROR)
+    err = pr_plan_tasks(pr, ops, &tasks, &tasks_len);
+
+  Range *ranges = NULL;
+  Range_Bound *range_bounds = NULL;
+  Node_Index ranges_len = 0;
+  if (err == ERR_NOERROR)
+    err = pr_plan_ranges(pr, ops, &ranges, &ranges_len, &range_bounds);
+
+  Branch *branches = NULL;
+  Node_Index branches_len = 0;
+  if (err == ERR_NOERROR)
+    err = pr_plan_branches(pr, ops, &branches, &branches_len);
+
+  // symbols of applied functions take their indices, once operations are set;
+  Function *functions = NULL;
+  Node_Index functions_len = 0, function_depth = 0;
+  if (err == ERR_NOERROR)
+    err = pr_plan_functions(pr, exec_len, &functions, &functions_len,
+        &function_depth);
+
+  if (err == ERR_NOERROR)
+    pr_plan_serial_reductions(pr, functions, ops);
+
+  // definitions are kept only from compiled programs;
+  if (err == ERR_NOERROR)
+    err = pr_keep_definitions(pr, defs, defs_len);
+  else
+    defs_free(defs, defs_len);
+
+  if (err != ERR_NOERROR) {
+    free(slot_syms);
+    free(ops);
+    free(tasks);
+    free(ranges);
+    free(range_bounds);
+    free(branches);
+    free(functions);
+    m->error = (Mewa_Error){
+        .code = err,
+        .row = pr->lx.rd.row,
+        .col = pr->lx.rd.col,
+        .token = pr->lx.tt,
+        .hint = err == ERR_PR_UNEXPECTED_EXPRESSION
+                    ? "consider adding ';' between expressions"
+                    : NULL,
+    };
+    return err;
+  }
+
+  [[maybe_unused]] Node_Index range_bounds_len = 0;
+  for (Node_Index i = 0; i < ranges_len; ++i)
+    range_bounds_len += ranges[i].len;
+
+  Mewa_Program *prog = malloc(sizeof(Mewa_Program));
+  if (prog == NULL) {
+    free(slot_syms);
+    free(ops);
+    free(tasks);
+    free(ranges);
+    free(range_bounds);
+    free(branches);
+    free(functions);
+    return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+  }
+  STATS_ALLOC(&m->stats, sizeof(Mewa_Program) +
+                             (slots_len - slots_temp) * sizeof(sym_t) +
+                             pr->nodes_len * sizeof(Op) +
+                             tasks_len * sizeof(Task) +
+                             branches_len * sizeof(Branch) +
+                             ranges_len * sizeof(Range) +
+                             range_bounds_len * sizeof(Range_Bound) +
+                             functions_len * sizeof(Function));
+
+  *prog = (Mewa_Program){
+      .root = root,
+      .nodes_len = pr->nodes_len,
+      .exec_len = exec_len,
+      // every call may execute a body on top of the stack of its caller;
+      .stack_depth = pr_stack_depth(pr->nodes, 0, exec_len) +
+                     FUNCTION_DEPTH_MAX * function_depth,
+      .ops = ops,
+      .tasks = tasks,
+      .tasks_len = tasks_len,
+      .branches = branches,
+      .branches_len = branches_len,
+      .ranges = ranges,
+      .ranges_len = ranges_len,
+      .range_bounds = range_bounds,
+      .functions = functions,
+      .functions_len = functions_len,
+      .slot_syms = slot_syms,
+      .slots_len = slots_len,
+      .slots_stored = slots_stored,
+      .slots_temp = slots_temp,
+      .interner = intern_ref(m->ir.interner),
+  };
+
+  if (pr->nodes_pos != NULL) {
+    prog->nodes_pos = malloc(pr->nodes_len * sizeof(Node_Pos));
+    if (prog->nodes_pos == NULL) {
+      mewa_program_free(prog);
+      return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+    }
+    STATS_ALLOC(&m->stats, pr->nodes_len * sizeof(Node_Pos));
+
+    memcpy(prog->nodes_pos, pr->nodes_pos, pr->nodes_len * sizeof(Node_Pos));
+  }
+
+  // large programs take buffer over instead of copying it, the next
+  // compilation allocates a new one, which costs no more than faulting pages
+  // of a copy in;
+  if (pr->nodes_len <= PROGRAM_COPY_MAX_NODES) {
+    prog->nodes = malloc(pr->nodes_len * sizeof(Node));
+    if (prog->nodes == NULL) {
+      mewa_program_free(prog);
+      return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+    }
+    STATS_ALLOC(&m->stats, pr->nodes_len * sizeof(Node));
+
+    memcpy(prog->nodes, pr->nodes, pr->nodes_len * sizeof(Node));
+  } else {
+    prog->nodes = realloc(pr->nodes, pr->nodes_len * sizeof(Node));
+    if (prog->nodes == NULL)
+      prog->nodes = pr->nodes;
+    pr->nodes = NULL;
+  }
+
+  *program = prog;
+  return ERR_NOERROR;
+}
+
+MEWA_API int mewa_compile(Mewa *m, const char *src, size_t len,
+                          Mewa_Program **program) {
+  Reader *rd = &m->pr->lx.rd;
+
+  // reader never writes to a page without source file;
+  rd->src = NULL;
+  rd->page = (String_Buffer){.data = (char *)src, .len = len, .cap = len};
+
+  return mewa_compile_reader(m, program);
+}
+
+MEWA_API int mewa_compile_file(Mewa *m, FILE *file, Mewa_Program **program) {
+  if (m->page == NULL) {
+    m->page = malloc(INTERNAL_READING_BUF_SIZE * sizeof(char));
+    if (m->page == NULL)
+      return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+    STATS_ALLOC(&m->stats, INTERNAL_READING_BUF_SIZE * sizeof(char));
+  }
+
+  Reader *rd = &m->pr->lx.rd;
+  rd->src = file;
+  rd->page = (String_Buffer){.data = m->page, .cap = INTERNAL_READING_BUF_SIZE};
+
+  return mewa_compile_reader(m, program);
+}
+
+MEWA_API void mewa_program_free(Mewa_Program *program) {
+  if (program == NULL)
+    return;
+
+  free(program->ops);
+  free(program->tasks);
+  free(program->branches);
+  free(program->ranges);
+  free(program->range_bounds);
+  free(program->functions);
+  free(program->slot_syms);
+  free(program->nodes_pos);
+  free(program->nodes);
+  intern_unref(program->interner);
+  free(program);
+}
+
+MEWA_API void mewa_program_print(const Mewa_Program *program, FILE *file) {
+  nd_tree_print(file, program->interner, program->nodes, program->root,
+      SOURCE_INDENTATION, SOURCE_INDENTATION + SOURCE_MAX_DEPTH);
+}
+
+//=:api:evaluation
+
+// api_name_len - returns length of name, or 0 if it does not follow rules of
+// identifiers of lexer;
+static size_t api_name_len(const char *name) {
+  if (!isalpha(name[0]))
+    return 0;
+
+  size_t len = 1;
+  for (; name[len] != '\0'; ++len)
+    if (len == SYMBOL_NAME_MAX || !(isalpha(name[len]) || isdigit(name[len])))
+      return 0;
+
+  return len;
+}
+
+MEWA_API int mewa_bind(Mewa *m, const char *name, double real, double imag) {
+  size_t len = api_name_len(name);
+  if (len == 0)
+    return mewa_fail(m, ERR_IR_SYM_INVALID);
+
+  sym_t sym = intern(m->ir.interner, name, len);
+  if (sym == 0)
+    return mewa_fail(m, ERR_IR_SYM_MEMORY_NOT_ENOUGH);
+
+  ERR err = ir_gscope_set(&m->ir, sym,
+      (Node){.type = NT_PRIM_CMX, .as.pm.c = CMPLX(real, imag), .rel_err = 0});
+  if (err != ERR_NOERROR)
+    return mewa_fail(m, err);
+
+  return ERR_NOERROR;
+}
+
+MEWA_API int mewa_unbind(Mewa *m, const char *name) {
+  size_t len = api_name_len(name);
+  if (len == 0)
+    return mewa_fail(m, ERR_IR_SYM_INVALID);
+
+  // names never interned were never bound, and are not interned by unbinding;
+  sym_t sym = intern_find(m->ir.interner, name, len, intern_hash(name, len));
+  ERR err = sym != 0 ? map_pop_Node(m->ir.gscope, m->ir.gscope_cap, sym)
+                     : ERR_G_HM_NOT_FOUND;
+  if (err != ERR_NOERROR)
+    return mewa_fail(m, err);
+
+  return ERR_NOERROR;
+}
+
+MEWA_API int mewa_eval(Mewa *m, const Mewa_Program *program,
+                       Mewa_Value *value) {
+  Interpreter *ir = &m->ir;
+
+  ir->nodes = program->nodes;
+  ir->ops = program->ops;
+  ir->nodes_pos = program->nodes_pos;
+  ir->nodes_len = program->nodes_len;
+  ir->exec_len = program->exec_len;
+  ir->names = program->interner;
+  ir->slot_syms = program->slot_syms;
+  ir->slots_len = program->slots_len;
+  ir->slots_stored = program->slots_stored;
+  ir->slots_temp = program->slots_temp;
+  ir->tasks = program->tasks;
+  ir->tasks_len = program->tasks_len;
+  ir->tasks_forked = TASK_NONE;
+  ir->branches = program->branches;
+  ir->branches_len = program->branches_len;
+  ir->ranges = program->ranges;
+  ir->ranges_len = program->ranges_len;
+  ir->range_bounds = program->range_bounds;
+  ir->functions = program->functions;
+  ir->functions_len = program->functions_len;
+  ir->calls = 0;
+  ++ir->memo_gen;
+  ir->stack_depth = program->stack_depth;
+
+  ERR err = ir_slots_reserve(ir, program->slots_len);
+  if (err == ERR_NOERROR && ir->names != ir->interner)
+    err = ir_slots_translate(ir);
+  if (err == ERR_NOERROR && program->stack_depth > STACK_LOCAL_MAX)
+    err = ir_st_reserve(ir, program->stack_depth);
+  if (err != ERR_NOERROR)
+    return mewa_fail(m, err);
+
+  // stacks of shallow programs are kept on the C stack, the heap one is put
+  // back before returning;
+  union {
+    Stack_Node st;
+    unsigned char bytes[sizeof(Stack_Node) + STACK_LOCAL_MAX * sizeof(Node)];
+  } local;
+
+  Stack_Node *heap = ir->st;
+  if (program->stack_depth <= STACK_LOCAL_MAX) {
+    local.st.cap = STACK_LOCAL_MAX;
+    ir->st = &local.st;
+  }
+
+  ir->st->len = 0;
+  STATS_MAX(ir->stats, st_depth, program->stack_depth);
+
+  // assignments made before an error are kept, as they would be by global
+  // scope;
+  ir_slots_load(ir);
+  err = ir_exec_instrumented(ir);
+  ERR store_err = ir_slots_store(ir);
+  if (err == ERR_NOERROR)
+    err = store_err;
+
+  Node result = {0};
+  if (ir->st->len != 0)
+    result = ir->st->data[0];
+  ir->st = heap;
+
+  if (err != ERR_NOERROR)
+    return mewa_fail(m, err);
+
+  *value = (Mewa_Value){.type = MEWA_NONE};
+
+  switch (result.type) {
+  case NT_PRIM_CMX:
+    *value = (Mewa_Value){
+        .type = MEWA_NUMBER,
+        .real = creal(result.as.pm.c),
+        .imag = cimag(result.as.pm.c),
+        .rel_err = result.rel_err,
+    };
+    break;
+  case NT_PRIM_PRB:
+    *value = (Mewa_Value){.type = MEWA_BOOL, .real = creal(result.as.pm.c)};
+    break;
+  default:
+    break;
+  }
+
+  return ERR_NOERROR;
+}
+
+//=:api:errors
+
+MEWA_API const Mewa_Error *mewa_error(const Mewa *m) { return &m->error; }
+
+MEWA_API const char *mewa_strerror(int code) { return err_stringify(code); }
+
+MEWA_API const char *mewa_strtoken(int token) { return tt_stringify(token); }
+
+//=:api:diagnostics
+
+MEWA_API int mewa_stats_enable(Mewa *m, bool json) {
+#ifdef NSTATS
+  (void)json;
+  return mewa_fail(m, ERR_API_DISABLED);
+#else
+  m->stats.enabled = true;
+  m->stats.json = json;
+  return ERR_NOERROR;
+#endif
+}
+
+MEWA_API void mewa_stats_print(Mewa *m, FILE *file) {
+#ifndef NSTATS
+  if (m->stats.enabled)
+    stats_print(&m->ir, file);
+#else
+  (void)m;
+  (void)file;
+#endif
+}
+
+MEWA_API int mewa_profile_enable(Mewa *m, FILE *folded) {
+#ifdef NPROFILE
+  (void)folded;
+  return mewa_fail(m, ERR_API_DISABLED);
+#else
+  if (m->ir.prof == NULL) {
+    m->ir.prof = calloc(1, sizeof(Profile));
+    if (m->ir.prof == NULL)
+      return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+    STATS_ALLOC(&m->stats, sizeof(Profile));
+  }
+
+  if (folded != NULL && m->ir.prof->nodes == NULL) {
+    m->ir.prof->nodes = calloc(NODE_BUF_SIZE, sizeof(Profile_Counter));
+    if (m->ir.prof->nodes == NULL)
+      return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+
+    m->pr->nodes_pos = malloc(NODE_BUF_SIZE * sizeof(Node_Pos));
+    if (m->pr->nodes_pos == NULL) {
+      free(m->ir.prof->nodes);
+      m->ir.prof->nodes = NULL;
+      return mewa_fail(m, ERR_IR_ALLOC_FAILED);
+    }
+
+    STATS_ALLOC(&m->stats,
+        NODE_BUF_SIZE * (sizeof(Profile_Counter) + sizeof(Node_Pos)));
+  }
+
+  m->ir.prof->folded = folded;
+  return ERR_NOERROR;
+#endif
+}
+
+MEWA_API void mewa_profile_print(Mewa *m, FILE *file) {
+#ifndef NPROFILE
+  if (m->ir.prof != NULL)
+    prof_print(m->ir.prof, m->ir.interner, file);
+#else
+  (void)m;
+  (void)file;
+#endif
+}
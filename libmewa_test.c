@@ -0,0 +1,490 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "mewa.h"
+
+static Mewa_Program *compile(Mewa *m, const char *src) {
+  Mewa_Program *program;
+  int err = mewa_compile(m, src, strlen(src), &program);
+  if (err != MEWA_OK) {
+    fprintf(stderr, "mewa_compile(\"%s\") = %s\n", src, mewa_strerror(err));
+    abort();
+  }
+
+  return program;
+}
+
+static Mewa_Value eval(Mewa *m, const Mewa_Program *program) {
+  Mewa_Value value;
+  int err = mewa_eval(m, program, &value);
+  if (err != MEWA_OK) {
+    fprintf(stderr, "mewa_eval = %s\n", mewa_strerror(err));
+    abort();
+  }
+
+  return value;
+}
+
+static void expect(Mewa *m, const char *src, Mewa_Type type, double real,
+                   double imag) {
+  Mewa_Program *program = compile(m, src);
+  Mewa_Value value = eval(m, program);
+  mewa_program_free(program);
+
+  if (value.type != type || fabs(value.real - real) > 1e-9 ||
+      fabs(value.imag - imag) > 1e-9) {
+    fprintf(stderr, "\"%s\" = (%d) %g %gi, want (%d) %g %gi\n", src,
+            value.type, value.real, value.imag, type, real, imag);
+    abort();
+  }
+}
+
+int main() {
+  Mewa *m = mewa_new();
+  assert(m != NULL);
+
+  expect(m, "1 + 2*3", MEWA_NUMBER, 7, 0);
+  expect(m, "2i*3", MEWA_NUMBER, 0, 6);
+  expect(m, "1 > 2", MEWA_BOOL, 0, 0);
+  expect(m, "y = 4", MEWA_NONE, 0, 0);
+  expect(m, "y * 2", MEWA_NUMBER, 8, 0);
+  expect(m, "pi", MEWA_NUMBER, M_PI, 0);
+
+  // one program is evaluated with different bindings;
+  Mewa_Program *square = compile(m, "x^2 + 1");
+  for (int x = 0; x <= 100; ++x) {
+    assert(mewa_bind(m, "x", x, 0) == MEWA_OK);
+    Mewa_Value value = eval(m, square);
+    assert(value.type == MEWA_NUMBER);
+    assert(fabs(value.real - (x * x + 1)) <= 1e-9 * (x * x + 1));
+  }
+
+  // handles do not share scopes, programs are shared;
+  Mewa *other = mewa_new();
+  assert(other != NULL);
+  assert(mewa_bind(other, "x", 3, 0) == MEWA_OK);
+  assert(fabs(eval(other, square).real - 10) < 1e-9);
+  assert(fabs(eval(m, square).real - 10001) < 1e-6);
+  mewa_program_free(square);
+
+  Mewa_Program *program;
+  Mewa_Value value;
+
+  // source is not required to be terminated;
+  assert(mewa_compile(m, "1 + 2 junk", 5, &program) == MEWA_OK);
+  assert(eval(m, program).real == 3);
+  mewa_program_free(program);
+
+  // errors are returned and recorded by handle;
+  int err = mewa_compile(m, "1 2", 3, &program);
+  assert(err != MEWA_OK && mewa_error(m)->code == err);
+  assert(strcmp(mewa_strerror(err), "ERR_PR_UNEXPECTED_EXPRESSION") == 0);
+  assert(mewa_error(m)->hint != NULL);
+
+  err = mewa_compile(m, "", 0, &program);
+  assert(strcmp(mewa_strerror(err), "ERR_PR_TOKEN_UNEXPECTED") == 0);
+
+  err = mewa_compile(m, "(1 + 2", 6, &program);
+  assert(strcmp(mewa_strerror(err), "ERR_PR_PAREN_NOT_CLOSED") == 0);
+
+  program = compile(m, "1 / 0");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_DIV_BY_ZERO") == 0);
+  mewa_program_free(program);
+
+  program = compile(m, "undefined + 1");
+  assert(mewa_eval(m, program, &value) != MEWA_OK);
+  mewa_program_free(program);
+
+  // assignments made before an error are kept;
+  program = compile(m, "kept = 5; kept / 0");
+  assert(mewa_eval(m, program, &value) != MEWA_OK);
+  mewa_program_free(program);
+  expect(m, "kept + 1", MEWA_NUMBER, 6, 0);
+
+  assert(mewa_bind(m, "", 1, 0) != MEWA_OK);
+  assert(mewa_bind(m, "1x", 1, 0) != MEWA_OK);
+  assert(mewa_bind(m, "a-b", 1, 0) != MEWA_OK);
+  assert(mewa_bind(m, "abcdefghij", 1, 0) == MEWA_OK);
+  expect(m, "abcdefghij + 1", MEWA_NUMBER, 2, 0);
+
+  // identifiers are not limited by size of a symbol;
+  assert(mewa_bind(m, "temperatureInKelvin", 300, 0) == MEWA_OK);
+  expect(m, "temperatureInKelvin - 273", MEWA_NUMBER, 27, 0);
+  expect(m, "temperatureInKelvinAtNoon = 2; temperatureInKelvinAtNoon * 3",
+      MEWA_NUMBER, 6, 0);
+
+  char name[SYMBOL_NAME_MAX + 2];
+  memset(name, 'a', sizeof name - 1);
+  name[sizeof name - 1] = '\0';
+  assert(mewa_bind(m, name, 1, 0) != MEWA_OK);
+  name[SYMBOL_NAME_MAX] = '\0';
+  assert(mewa_bind(m, name, 1, 0) == MEWA_OK);
+
+  // unbinding forgets one variable, entries which collided with it are still
+  // found, and its entry is reused;
+  Mewa *scope = mewa_new();
+  assert(scope != NULL);
+  enum { BOUND = GLOBAL_SCOPE_CAPACITY - 4 };
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < BOUND; ++i) {
+      snprintf(name, sizeof name, "r%dv%d", round, i);
+      assert(mewa_bind(scope, name, i, 0) == MEWA_OK);
+    }
+
+    for (int i = 0; i < BOUND; i += 2) {
+      snprintf(name, sizeof name, "r%dv%d", round, i);
+      assert(mewa_unbind(scope, name) == MEWA_OK);
+      assert(mewa_unbind(scope, name) != MEWA_OK);
+    }
+
+    for (int i = 0; i < BOUND; ++i) {
+      snprintf(name, sizeof name, "r%dv%d", round, i);
+      program = compile(scope, name);
+      err = mewa_eval(scope, program, &value);
+      mewa_program_free(program);
+      assert(i % 2 == 0 ? strcmp(mewa_strerror(err), "ERR_G_HM_NOT_FOUND") == 0
+                        : err == MEWA_OK && value.real == i);
+
+      assert(i % 2 == 0 || mewa_unbind(scope, name) == MEWA_OK);
+    }
+  }
+
+  expect(scope, "pi", MEWA_NUMBER, M_PI, 0);
+  assert(mewa_unbind(scope, "never") != MEWA_OK);
+  assert(mewa_unbind(scope, "1x") != MEWA_OK);
+  mewa_free(scope);
+
+  // files are read in pages, large programs take buffer of parser over;
+  FILE *file = tmpfile();
+  assert(file != NULL);
+  for (int i = 0; i < 3000; ++i)
+    fputs("1 + ", file);
+  fputs("1", file);
+  rewind(file);
+
+  assert(mewa_compile_file(m, file, &program) == MEWA_OK);
+  assert(eval(m, program).real == 3001);
+  mewa_program_free(program);
+  fclose(file);
+
+  // reset forgets variables, but keeps builtin constants;
+  mewa_reset(m);
+  program = compile(m, "y");
+  assert(mewa_eval(m, program, &value) != MEWA_OK);
+  mewa_program_free(program);
+  expect(m, "pi", MEWA_NUMBER, M_PI, 0);
+
+  // literals take exponents;
+  expect(m, "1.5e3 + 2E-2", MEWA_NUMBER, 1500.02, 0);
+  err = mewa_compile(m, "1e", 2, &program);
+  assert(err != MEWA_OK);
+
+  // reductions bind their variable to every integer of range and restore it;
+  expect(m, "sum(k, 1, 100, k)", MEWA_NUMBER, 5050, 0);
+  expect(m, "prod(k, 1, 10, k)", MEWA_NUMBER, 3628800, 0);
+  expect(m, "min(k, -3, 3, k*k - 2*k)", MEWA_NUMBER, -1, 0);
+  expect(m, "max(k, 0.5, 3.5, -k)", MEWA_NUMBER, -1, 0);
+  expect(m, "sum(k, 1, 4, sum(j, 1, k, j))", MEWA_NUMBER, 20, 0);
+  expect(m, "sum(k, 1, 3, k*1i)", MEWA_NUMBER, 0, 6);
+  expect(m, "k = 7; sum(k, 1, 3, k) + k", MEWA_NUMBER, 13, 0);
+  expect(m, "sum(k, 1, 3, (t = k; t*t)) + t", MEWA_NUMBER, 17, 0);
+  expect(m, "sum(k, 3, 1, k) + prod(k, 3, 1, k)", MEWA_NUMBER, 1, 0);
+
+  program = compile(m, "min(k, 3, 1, k)");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_RANGE_EMPTY") == 0);
+  mewa_program_free(program);
+
+  program = compile(m, "sum(k, 1, 1e18, k)");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_RANGE_TOO_LONG") == 0);
+  mewa_program_free(program);
+
+  // reductions take a variable, bounds and body;
+  const char *const bad_reductions[] = {
+      "sum(k, 1, 2)", "sum(k, 1, 2, 3, 4)", "solve(x, 0, 1)",
+      "sum(k + 1, 1, 3, 2)", "integrate(1, 0, 1, x)",
+  };
+  for (size_t i = 0; i < sizeof bad_reductions / sizeof *bad_reductions; ++i) {
+    const char *src = bad_reductions[i];
+    err = mewa_compile(m, src, strlen(src), &program);
+    assert(strcmp(mewa_strerror(err), "ERR_PR_ARGS_MISMATCH") == 0);
+  }
+
+  // solve and integrate evaluate body at points they choose;
+  expect(m, "solve(x, 0, 2, x*x - 2)", MEWA_NUMBER, sqrt(2), 0);
+  expect(m, "solve(x, 2, 3, x*x*x - 2*x - 5)", MEWA_NUMBER, 2.0945514815423265, 0);
+  expect(m, "integrate(x, 0, 1, 4/(1 + x*x))", MEWA_NUMBER, M_PI, 0);
+  expect(m, "integrate(x, 0, 1, 1/sqrt(x))", MEWA_NUMBER, 2, 0);
+  expect(m, "integrate(t, 0, 2, t*1i)", MEWA_NUMBER, 0, 2);
+  expect(m, "integrate(t, 0, 1, integrate(s, 0, t, s))", MEWA_NUMBER, 1.0 / 6, 0);
+
+  program = compile(m, "integrate(x, 0, 1, 1/sqrt(x))");
+  value = eval(m, program);
+  assert(value.rel_err > 0 && value.rel_err < 1e-9);
+  mewa_program_free(program);
+
+  program = compile(m, "solve(x, 0, 1, x*x + 1)");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_ROOT_NOT_BRACKETED") == 0);
+  mewa_program_free(program);
+
+  // unary operators apply to the whole operand;
+  expect(m, "-(1 + 2)", MEWA_NUMBER, -3, 0);
+  expect(m, "|1 - 4| * 2", MEWA_NUMBER, 6, 0);
+  expect(m, "-2^2", MEWA_NUMBER, -4, 0);
+  expect(m, "2 * -3 + 1", MEWA_NUMBER, -5, 0);
+
+  // fused operations keep order of operands;
+  expect(m, "a = 3; 10 - a - 2*a^2 / (a - 1)", MEWA_NUMBER, -2, 0);
+  expect(m, "3! - 2^3 + (1 - a)", MEWA_NUMBER, -4, 0);
+
+  // repeated subtrees are evaluated once, but not across assignments;
+  expect(m, "x = 2; (x*3 + 1)*(x*3 + 1) - (x*3 + 1)", MEWA_NUMBER, 42, 0);
+  expect(m, "a = 3; b = a*a + 1; a = 4; b + (a*a + 1)", MEWA_NUMBER, 27, 0);
+  expect(m, "k = 3; sum(k, 1, 3, (k*2 + 1)*(k*2 + 1)) + (k*2 + 1)", MEWA_NUMBER, 90, 0);
+
+  program = compile(m, "x = 2; x*3 + 1; (x*3 + 1) = 1");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_NOT_DEFINED_FOR_TYPE") == 0);
+  mewa_program_free(program);
+
+  // operators are simplified, powers of integers are multiplied exactly;
+  expect(m, "x = 1 + 2i; x^3 + -(-x)*1 + x/4 - 0", MEWA_NUMBER, -9.75, 0.5);
+  expect(m, "sum(k, 1, 3, (k + 1)*1) + sum(k, 1, 10, +(k^2)/2)", MEWA_NUMBER, 201.5, 0);
+
+  program = compile(m, "x = 1 + 2i; x^3");
+  value = eval(m, program);
+  mewa_program_free(program);
+  assert(value.real == -11 && value.imag == -2);
+
+  program = compile(m, "b = 1 > 0; -(-b)*1");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_NOT_DEFINED_FOR_TYPE") == 0);
+  mewa_program_free(program);
+
+  // the first node of program is dropped or kept by simplification;
+  expect(m, "0 + 1", MEWA_NUMBER, 1, 0);
+  expect(m, "1*2*3", MEWA_NUMBER, 6, 0);
+  expect(m, "5*1", MEWA_NUMBER, 5, 0);
+  expect(m, "5 + 0", MEWA_NUMBER, 5, 0);
+  expect(m, "5 - 0", MEWA_NUMBER, 5, 0);
+  expect(m, "(0.5)^1", MEWA_NUMBER, 0.5, 0);
+
+  Mewa_Program *plus = compile(m, "0 + x"), *times = compile(m, "1*x");
+  for (int x = -2; x <= 2; ++x) {
+    assert(mewa_bind(m, "x", x, 0) == MEWA_OK);
+    assert(eval(m, plus).real == x && eval(m, times).real == x);
+  }
+  mewa_program_free(plus);
+  mewa_program_free(times);
+
+  // polynomials of a variable are evaluated by their coefficients;
+  expect(m, "x = 2; 3*x^3 - x^2*2 + -(x - 1)", MEWA_NUMBER, 15, 0);
+  expect(m, "sum(k, 1, 10, 3*k^3 + 2*k^2 + k + 1)", MEWA_NUMBER, 9910, 0);
+  expect(m, "x = 1 + i; y = 2; x^2 + 2*x + 1 + y^2", MEWA_NUMBER, 7, 4);
+
+  // the first node of program is a coefficient or the variable;
+  const char *polys[] = {"2*x^2 + 3*x + 1", "x^2 + 2*x + 1", "3*x^2 + 1",
+                         "2*x^2 + x", "x/2 + x^2"};
+  for (size_t i = 0; i < sizeof polys / sizeof *polys; ++i) {
+    Mewa_Program *poly = compile(m, polys[i]);
+    for (int x = -3; x <= 3; ++x) {
+      double want[] = {2.0*x*x + 3*x + 1, x*x + 2.0*x + 1, 3.0*x*x + 1,
+                       2.0*x*x + x, x/2.0 + x*x};
+      assert(mewa_bind(m, "x", x, 0) == MEWA_OK);
+      assert(eval(m, poly).real == want[i]);
+    }
+    mewa_program_free(poly);
+  }
+
+  // polynomials of high degree are evaluated by Estrin's scheme;
+  expect(m,
+         "x = 0.5; 1 + x + x^2 + x^3 + x^4 + x^5 + x^6 + x^7 + x^8 + "
+         "x^9 + x^10 + x^11 + x^12 + x^13 + x^14 + x^15 + x^16 + x^17 + "
+         "x^18 + x^19 + x^20 + x^21 + x^22 + x^23 + x^24 + x^25 + "
+         "x^26 + x^27 + x^28 + x^29 + x^30 + x^31 + x^32 + x^33 + "
+         "x^34 + x^35 + x^36 + x^37 + x^38 + x^39 + x^40",
+         MEWA_NUMBER, 2 - pow(0.5, 40), 0);
+
+  // only the taken alternative of a conditional is evaluated;
+  expect(m, "x = -3; x < 0 -> -x, x", MEWA_NUMBER, 3, 0);
+  expect(m, "x = 0; x < 0 -> -1, x > 0 -> 1, 0", MEWA_NUMBER, 0, 0);
+  expect(m, "x = 5; 1 + (x < 0 -> 1/0, x > 0 -> 2, 1/0) * 3", MEWA_NUMBER, 7,
+         0);
+  expect(m, "x = 1; x > 0 -> (x > 2 -> 10, 20), 30", MEWA_NUMBER, 20, 0);
+  expect(m, "sum(k, 1, 10, (k % 2 == 0 -> k, 0))", MEWA_NUMBER, 30, 0);
+  expect(m, "integrate(t, 0, 2, (t < 1 -> t, 2 - t))", MEWA_NUMBER, 1, 0);
+
+  program = compile(m, "x = 1; x < 0 -> -x");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_NO_ALTERNATIVE") == 0);
+  mewa_program_free(program);
+
+  // alternatives testing a variable against sorted literals are ranged;
+  expect(m,
+         "sum(k, 1, 100, (k < 10 -> 1, k < 20 -> 2, k < 50 -> 3, k < 80 -> 4, "
+         "5))",
+         MEWA_NUMBER, 344, 0);
+  expect(m, "x = 3; x > 3 -> 1, x > 2 -> 2, x > 2 -> 3, x > 1 -> 4, 5",
+         MEWA_NUMBER, 2, 0);
+  expect(m,
+         "x = 7; x < 1 -> 1, x < 2 -> 2, x < 3 -> 3, x < 6 -> 6, x > 0 -> 7, 0",
+         MEWA_NUMBER, 7, 0);
+  expect(m,
+         "x = 1.5; y = 3; x < 1 -> 1, x < 2 -> (y < 1 -> 10, y < 2 -> 20, "
+         "y < 3 -> 30, y < 4 -> 40, 50), x < 3 -> 3, x < 4 -> 4, 5",
+         MEWA_NUMBER, 40, 0);
+
+  program = compile(m, "x = 2i; x < 1 -> 1, x < 2 -> 2, x < 3 -> 3, x < 4 -> 4");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_NOT_DEFINED_FOR_TYPE") == 0);
+  mewa_program_free(program);
+
+  program = compile(m, "x = 4; x < 1 -> 1, x < 2 -> 2, x < 3 -> 3, x < 4 -> 4");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_NO_ALTERNATIVE") == 0);
+  mewa_program_free(program);
+
+  // functions are defined by assignments to calls of their parameters;
+  expect(m, "f(x) = x^2 + 1; f(3)", MEWA_NUMBER, 10, 0);
+  expect(m, "g(x, y) = x*y - y; g(4, 5) + f(1)", MEWA_NUMBER, 17, 0);
+  expect(m, "f(x) = 2*x; f(x) = 3*x; f(2)", MEWA_NUMBER, 6, 0);
+  expect(m, "a = 5; h(x) = a*x; a = 2; h(3)", MEWA_NUMBER, 6, 0);
+  expect(m, "sum(k, 1, 10, g(k, 2))", MEWA_NUMBER, 90, 0);
+  expect(m, "s(n) = sum(k, 1, n, k); s(4) + s(10)", MEWA_NUMBER, 65, 0);
+
+  // values of pure functions are cached, so recursion is linear;
+  expect(m, "fib(n) = (n < 2 -> n, fib(n - 1) + fib(n - 2)); fib(90)",
+         MEWA_NUMBER, 2880067194370816120.0, 0);
+
+  err = mewa_compile(m, "g(1)", 4, &program);
+  assert(strcmp(mewa_strerror(err), "ERR_PR_ARGS_MISMATCH") == 0);
+
+  // parameters are named once, and builtins are not redefined;
+  err = mewa_compile(m, "p(a, a) = a; p(1, 2)", 20, &program);
+  assert(strcmp(mewa_strerror(err), "ERR_PR_PARAM_REPEATED") == 0);
+  err = mewa_compile(m, "p(a, b, a) = b", 14, &program);
+  assert(strcmp(mewa_strerror(err), "ERR_PR_PARAM_REPEATED") == 0);
+  err = mewa_compile(m, "sin(x) = 2; sin(1)", 18, &program);
+  assert(strcmp(mewa_strerror(err), "ERR_PR_BUILTIN_REDEFINED") == 0);
+  expect(m, "sin(0) + f(1)", MEWA_NUMBER, 3, 0);
+
+  program = compile(m, "d(n) = (n < 1 -> 0, 1 + d(n - 1)); d(1e6)");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_CALLS_TOO_DEEP") == 0);
+  mewa_program_free(program);
+  expect(m, "d(100)", MEWA_NUMBER, 100, 0);
+
+  // identifiers may start with i;
+  expect(m, "ix = 2; ix*i", MEWA_NUMBER, 0, 2);
+
+  // results do not depend on number of threads;
+  program = compile(m, "sum(k, 1, 1e6, 1/(k*k))");
+  Mewa_Value serial, parallel;
+  mewa_threads(m, 1);
+  serial = eval(m, program);
+  mewa_threads(m, 4);
+  parallel = eval(m, program);
+  mewa_program_free(program);
+
+  assert(fabs(serial.real - (M_PI * M_PI / 6 - 1e-6)) < 1e-12);
+  assert(memcmp(&serial.real, &parallel.real, sizeof(double)) == 0);
+  assert(serial.rel_err == parallel.rel_err);
+
+  program = compile(m, "sum(k, 1, 1e5, 1/(k - 50000))");
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_DIV_BY_ZERO") == 0);
+  mewa_program_free(program);
+
+  // heavy independent subtrees are evaluated by threads of their own;
+  char fac[101], src[512];
+  memset(fac, '!', sizeof fac - 1);
+  fac[sizeof fac - 1] = '\0';
+
+  snprintf(src, sizeof src, "x = 3; (100%s + x) * (90%s - x) / (80%s + 70%s)",
+      fac, fac, fac, fac);
+  program = compile(m, src);
+  mewa_threads(m, 1);
+  serial = eval(m, program);
+  mewa_threads(m, 4);
+  parallel = eval(m, program);
+  mewa_program_free(program);
+
+  assert(fabs(serial.real - 103.0 * 87 / 150) < 1e-9);
+  assert(memcmp(&serial.real, &parallel.real, sizeof(double)) == 0);
+  assert(serial.rel_err == parallel.rel_err);
+
+  snprintf(src, sizeof src, "x = 3; (100%s + x*x*x) * (90%s + x*x*x)", fac, fac);
+  program = compile(m, src);
+  mewa_threads(m, 1);
+  serial = eval(m, program);
+  mewa_threads(m, 4);
+  parallel = eval(m, program);
+  mewa_program_free(program);
+
+  assert(fabs(serial.real - 127.0 * 117) < 1e-9 * 127 * 117);
+  assert(memcmp(&serial.real, &parallel.real, sizeof(double)) == 0);
+
+  snprintf(src, sizeof src, "90%s + (1/0)%s", fac, fac);
+  program = compile(m, src);
+  err = mewa_eval(m, program, &value);
+  assert(strcmp(mewa_strerror(err), "ERR_IR_DIV_BY_ZERO") == 0);
+  mewa_program_free(program);
+
+  // stacks of deep programs are allocated on the heap, for every thread;
+  char deep[1024] = "sum(k, 1, 3e4, ";
+  for (int i = 0; i < 100; ++i)
+    strcat(deep, "1 + (");
+  strcat(deep, "k");
+  for (int i = 0; i < 100; ++i)
+    strcat(deep, ")");
+  strcat(deep, ")");
+
+  program = compile(m, deep);
+  mewa_threads(m, 1);
+  serial = eval(m, program);
+  mewa_threads(m, 4);
+  parallel = eval(m, program);
+  mewa_program_free(program);
+
+  assert(serial.real == 100.0 * 3e4 + 3e4 * (3e4 + 1) / 2);
+  assert(memcmp(&serial.real, &parallel.real, sizeof(double)) == 0);
+
+  // programs outlive resets of their handle, and are evaluated by handles
+  // which number their names differently;
+  program = compile(other, "y - x");
+  mewa_reset(other);
+  assert(mewa_bind(other, "zz", 0, 0) == MEWA_OK);
+  assert(mewa_bind(other, "x", 1, 0) == MEWA_OK);
+  assert(mewa_bind(other, "y", 3, 0) == MEWA_OK);
+  assert(eval(other, program).real == 2);
+  assert(mewa_bind(m, "y", 1, 0) == MEWA_OK);
+  assert(mewa_bind(m, "x", 3, 0) == MEWA_OK);
+  assert(eval(m, program).real == -2);
+  mewa_program_free(program);
+
+  // names are dropped by reset, so a served handle never runs out of them;
+  enum { NAMES = 1 << 16 };
+  char *names = malloc(NAMES * 12);
+  assert(names != NULL);
+  for (int round = 0; round <= INTERN_SYMBOLS_MAX / NAMES; ++round) {
+    size_t len = 0;
+    for (int i = 0; i < NAMES; ++i)
+      len += sprintf(names + len, "r%dv%d;", round, i);
+
+    assert(mewa_compile(other, names, len - 1, &program) == MEWA_OK);
+    mewa_program_free(program);
+    mewa_reset(other);
+  }
+  free(names);
+
+  mewa_free(other);
+  mewa_free(m);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef MEWA_H
+#define MEWA_H
+
+// libmewa - compiles expressions once and evaluates them many times.
+//
+//   Mewa *m = mewa_new();
+//   Mewa_Program *p;
+//   if (mewa_compile(m, "x^2 + 1", 7, &p) == MEWA_OK) {
+//     for (double x = 0; x < 10; ++x) {
+//       Mewa_Value v;
+//       mewa_bind(m, "x", x, 0);
+//       if (mewa_eval(m, p, &v) == MEWA_OK)
+//         printf("%g\n", v.real);
+//     }
+//     mewa_program_free(p);
+//   }
+//   mewa_free(m);
+//
+// A handle owns its global scope, value stack and statistics, so different
+// handles may be used from different threads; one handle must not be used by
+// two threads at a time. Programs are immutable and may be evaluated by any
+// handle. Functions return MEWA_OK or an error code, which is also stored
+// with its position in mewa_error(). Library never exits the process.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#if defined(__GNUC__) && !defined(_WIN32)
+#define MEWA_API __attribute__((visibility("default")))
+#else
+#define MEWA_API
+#endif
+
+#define MEWA_OK (0)
+
+typedef struct Mewa Mewa;
+
+typedef struct Mewa_Program Mewa_Program;
+
+typedef enum {
+  MEWA_NONE,
+  MEWA_NUMBER,
+  MEWA_BOOL,
+} Mewa_Type;
+
+// Mewa_Value - result of evaluation. Booleans are probabilities in real;
+typedef struct {
+  Mewa_Type type;
+  double real;
+  double imag;
+  float rel_err;
+} Mewa_Value;
+
+// Mewa_Error - the last error of a handle. Position, token and hint are set
+// only by compilation;
+typedef struct {
+  int code;
+  size_t row;
+  size_t col;
+  int token;
+  const char *hint;
+} Mewa_Error;
+
+//=:api:handle
+
+// mewa_new - creates handle with builtin constants bound, NULL if out of
+// memory;
+MEWA_API Mewa *mewa_new(void);
+
+MEWA_API void mewa_free(Mewa *m);
+
+// mewa_reset - forgets variables of handle, keeping its buffers allocated;
+MEWA_API void mewa_reset(Mewa *m);
+
+// mewa_threads - sets number of threads evaluating large reductions and
+// heavy independent subtrees of handle, 0 is a thread per processor, 1
+// evaluates them serially. Results do not depend on it. Threads are started by
+// the first reduction or subtrees split across them;
+MEWA_API void mewa_threads(Mewa *m, unsigned threads);
+
+//=:api:program
+
+// mewa_compile - compiles len bytes of src, which need not be terminated;
+MEWA_API int mewa_compile(Mewa *m, const char *src, size_t len,
+                          Mewa_Program **program);
+
+// mewa_compile_file - compiles the rest of file;
+MEWA_API int mewa_compile_file(Mewa *m, FILE *file, Mewa_Program **program);
+
+MEWA_API void mewa_program_free(Mewa_Program *program);
+
+// mewa_program_print - prints syntax tree of program;
+MEWA_API void mewa_program_print(const Mewa_Program *program, FILE *file);
+
+//=:api:evaluation
+
+// mewa_bind - assigns number to a variable of global scope of handle. Names
+// are identifiers of up to 256 letters and digits;
+MEWA_API int mewa_bind(Mewa *m, const char *name, double real, double imag);
+
+// mewa_unbind - removes a variable from global scope of handle, so later
+// evaluations fail to read it until it is bound or assigned again. Unlike
+// mewa_reset, other variables are kept;
+MEWA_API int mewa_unbind(Mewa *m, const char *name);
+
+// mewa_eval - evaluates program. Assignments made by it remain in global
+// scope of handle;
+MEWA_API int mewa_eval(Mewa *m, const Mewa_Program *program,
+                       Mewa_Value *value);
+
+//=:api:errors
+
+MEWA_API const Mewa_Error *mewa_error(const Mewa *m);
+
+MEWA_API const char *mewa_strerror(int code);
+
+MEWA_API const char *mewa_strtoken(int token);
+
+//=:api:diagnostics
+
+// mewa_stats_enable - starts collection of statistics of every phase, fails
+// when it is compiled out;
+MEWA_API int mewa_stats_enable(Mewa *m, bool json);
+
+// mewa_stats_print - prints statistics, when they are enabled;
+MEWA_API void mewa_stats_print(Mewa *m, FILE *file);
+
+// mewa_profile_enable - starts profiling of executed nodes, fails when it is
+// compiled out. Folded stacks of every evaluation are written to folded, when
+// it is not NULL, for programs compiled after this call;
+MEWA_API int mewa_profile_enable(Mewa *m, FILE *folded);
+
+// mewa_profile_print - prints profile, when profiling is enabled;
+MEWA_API void mewa_profile_print(Mewa *m, FILE *file);
+
+#endif
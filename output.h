@@ -0,0 +1,224 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "config.h"
+
+#include "dtoa.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//=:output:output
+
+typedef enum {
+  OC_RESET,
+  OC_PRIM,
+  OC_INTERNAL,
+  OC_COUNT,
+} Output_Color;
+
+// Output - buffer of results written to stdout or, in binary mode, to a file. It is flushed when full and,
+// on terminals, at the end of every line. Colors are resolved once by
+// out_init: escape sequences are empty strings when output is not a terminal.
+typedef struct {
+  FILE *file;
+  bool line_buffered;
+  bool binary;
+  const char *clr[OC_COUNT];
+
+  size_t len;
+  char data[OUTPUT_BUF_SIZE];
+} Output;
+
+static Output out;
+
+static inline void out_drain(void) {
+  if (out.len != 0)
+    fwrite(out.data, 1, out.len, out.file);
+  out.len = 0;
+}
+
+static inline void out_flush(void) {
+  out_drain();
+  fflush(out.file);
+}
+
+static inline void out_init(FILE *file, bool tty) {
+  out.file = file;
+  out.line_buffered = tty;
+  out.len = 0;
+
+  bool colors = tty && getenv("NO_COLOR") == NULL;
+  out.clr[OC_RESET] = colors ? "" CLR_RESET : "";
+  out.clr[OC_PRIM] = colors ? "" CLR_PRIM : "";
+  out.clr[OC_INTERNAL] = colors ? "" CLR_INTERNAL : "";
+
+  // the buffer above replaces buffering of stdio;
+  setvbuf(file, NULL, _IONBF, 0);
+  atexit(out_flush);
+}
+
+// out_commit - accounts n bytes written to the buffer and applies line policy;
+static inline void out_commit(size_t n) {
+  if (out.line_buffered && memchr(&out.data[out.len], '\n', n) != NULL) {
+    out.len += n;
+    out_drain();
+    return;
+  }
+
+  out.len += n;
+}
+
+static inline void out_write(const char *s, size_t n) {
+  if (n > OUTPUT_BUF_SIZE - out.len) {
+    out_drain();
+
+    if (n > OUTPUT_BUF_SIZE) {
+      fwrite(s, 1, n, out.file);
+      return;
+    }
+  }
+
+  memcpy(&out.data[out.len], s, n);
+  out_commit(n);
+}
+
+static inline void out_str(const char *s) { out_write(s, strlen(s)); }
+
+static inline void out_chr(char c) {
+  if (out.len == OUTPUT_BUF_SIZE)
+    out_drain();
+
+  out.data[out.len] = c;
+  out_commit(1);
+}
+
+static inline void out_clr(Output_Color c) { out_str(out.clr[c]); }
+
+[[gnu::format(printf, 1, 2)]]
+static inline void out_fmt(const char *fmt, ...) {
+  va_list ap;
+
+  va_start(ap, fmt);
+  int n = vsnprintf(&out.data[out.len], OUTPUT_BUF_SIZE - out.len, fmt, ap);
+  va_end(ap);
+
+  if (n < 0)
+    return;
+
+  if ((size_t)n >= OUTPUT_BUF_SIZE - out.len) {
+    out_drain();
+
+    va_start(ap, fmt);
+    if ((size_t)n < OUTPUT_BUF_SIZE)
+      vsnprintf(out.data, OUTPUT_BUF_SIZE, fmt, ap);
+    else
+      vfprintf(out.file, fmt, ap);
+    va_end(ap);
+
+    if ((size_t)n >= OUTPUT_BUF_SIZE)
+      return;
+  }
+
+  out_commit(n);
+}
+
+// out_reserve - makes room for n bytes in the buffer, n <= OUTPUT_BUF_SIZE;
+static inline char *out_reserve(size_t n) {
+  if (n > OUTPUT_BUF_SIZE - out.len)
+    out_drain();
+
+  return &out.data[out.len];
+}
+
+static inline void out_int(int32_t v) {
+  char *dst = out_reserve(12);
+  uint32_t abs = v < 0 ? -(uint32_t)v : (uint32_t)v;
+  uint32_t len = dt_decimal_length(abs);
+
+  size_t sign = v < 0;
+  if (sign)
+    dst[0] = '-';
+  dt_digits(&dst[sign], abs, len);
+  out_commit(sign + len);
+}
+
+// out_dbl - writes shortest representation of v that reads back as v;
+static inline void out_dbl(double v) {
+  out_commit(dt_format(out_reserve(DT_BUF_SIZE), v));
+}
+
+// out_dbl_sci - writes significand of v and returns its decimal exponent;
+static inline int32_t out_dbl_sci(double v) {
+  int32_t exponent;
+  out_commit(dt_format_sci(out_reserve(DT_BUF_SIZE), v, &exponent));
+  return exponent;
+}
+
+//=:output:binary
+
+// Output_Tag - kind of value of a binary record;
+typedef enum {
+  OT_NONE,
+  OT_CMX,
+  OT_PRB,
+} Output_Tag;
+
+// record layout, all fields are little-endian:
+//
+// | Offset | Size | Field                         |
+// |:-------|:-----|:------------------------------|
+// | 0      | 8    | real part, IEEE 754 binary64  |
+// | 8      | 8    | imaginary part, binary64      |
+// | 16     | 4    | relative error, binary32      |
+// | 20     | 4    | tag, Output_Tag               |
+#define OUTPUT_RECORD_SIZE (24)
+
+static inline void out_le(char *dst, uint64_t v, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = (char)(v >> (8 * i));
+}
+
+// out_record - writes one binary record;
+static inline void out_record(double real, double imag, float rel_err,
+                              Output_Tag tag) {
+  char *dst = out_reserve(OUTPUT_RECORD_SIZE);
+
+  uint64_t real_bits, imag_bits;
+  uint32_t rel_err_bits;
+  memcpy(&real_bits, &real, sizeof real);
+  memcpy(&imag_bits, &imag, sizeof imag);
+  memcpy(&rel_err_bits, &rel_err, sizeof rel_err);
+
+  out_le(&dst[0], real_bits, 8);
+  out_le(&dst[8], imag_bits, 8);
+  out_le(&dst[16], rel_err_bits, 4);
+  out_le(&dst[20], tag, 4);
+
+  out.len += OUTPUT_RECORD_SIZE;
+}
+
+#endif
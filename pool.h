@@ -0,0 +1,274 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef POOL_H
+#define POOL_H
+
+// pool - threads running chunks [0, n) of a task with work stealing.
+//
+// Every worker starts with an equal slice of chunks and takes them from its
+// front. A worker without chunks steals the back half of slice of another
+// one, so a slow chunk does not hold the others. The calling thread is the
+// worker 0, pool_run returns when every chunk is done.
+
+#include "config.h"
+
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <unistd.h>
+#endif
+
+// Pool_Task - runs one chunk on behalf of worker;
+typedef void Pool_Task(void *ctx, unsigned worker, size_t chunk);
+
+// pool_cpus - returns number of online processors, at least 1;
+static inline unsigned pool_cpus(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (unsigned)n : 1;
+#else
+  return 1;
+#endif
+}
+
+#ifdef NTHREADS
+typedef struct Pool Pool;
+
+static inline Pool *pool_new([[maybe_unused]] unsigned threads) {
+  return NULL;
+}
+
+static inline void pool_free([[maybe_unused]] Pool *pool) {}
+
+static inline unsigned pool_threads([[maybe_unused]] const Pool *pool) {
+  return 1;
+}
+
+static inline void pool_run([[maybe_unused]] Pool *pool, size_t chunks,
+                            Pool_Task *task, void *ctx) {
+  for (size_t i = 0; i < chunks; ++i)
+    task(ctx, 0, i);
+}
+#else
+#include <pthread.h>
+
+//=:pool:queue
+
+// Pool_Queue - chunks [begin, end) left to a worker;
+typedef struct {
+  alignas(64) pthread_mutex_t lock;
+  size_t begin;
+  size_t end;
+} Pool_Queue;
+
+typedef struct Pool {
+  unsigned threads;
+  pthread_t *tids;
+  Pool_Queue *queues;
+
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  uint64_t generation;
+  unsigned running;
+  bool stop;
+
+  Pool_Task *task;
+  void *ctx;
+} Pool;
+
+// pool_take - takes chunk of own queue or steals a half of another queue;
+static inline bool pool_take(Pool *pool, unsigned worker, size_t *chunk) {
+  Pool_Queue *own = &pool->queues[worker];
+
+  pthread_mutex_lock(&own->lock);
+  bool taken = own->begin < own->end;
+  if (taken)
+    *chunk = own->begin++;
+  pthread_mutex_unlock(&own->lock);
+
+  if (taken)
+    return true;
+
+  for (unsigned i = 1; i < pool->threads; ++i) {
+    Pool_Queue *victim = &pool->queues[(worker + i) % pool->threads];
+
+    pthread_mutex_lock(&victim->lock);
+    size_t left = victim->end - victim->begin;
+    size_t end = victim->end;
+    victim->end -= (left + 1) / 2;
+    size_t begin = victim->end;
+    pthread_mutex_unlock(&victim->lock);
+
+    if (left == 0)
+      continue;
+
+    // the first stolen chunk is run right away, the rest is left to others;
+    pthread_mutex_lock(&own->lock);
+    own->begin = begin + 1;
+    own->end = end;
+    pthread_mutex_unlock(&own->lock);
+
+    *chunk = begin;
+    return true;
+  }
+
+  return false;
+}
+
+static inline void pool_work(Pool *pool, unsigned worker) {
+  size_t chunk;
+  while (pool_take(pool, worker, &chunk))
+    pool->task(pool->ctx, worker, chunk);
+}
+
+//=:pool:threads
+
+typedef struct {
+  Pool *pool;
+  unsigned worker;
+} Pool_Worker;
+
+static inline void *pool_main(void *arg) {
+  Pool *pool = ((Pool_Worker *)arg)->pool;
+  unsigned worker = ((Pool_Worker *)arg)->worker;
+  free(arg);
+
+  uint64_t generation = 0;
+
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (!pool->stop && pool->generation == generation)
+      pthread_cond_wait(&pool->start, &pool->lock);
+    if (pool->stop)
+      break;
+    generation = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_work(pool, worker);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->running == 0)
+      pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  return NULL;
+}
+
+static inline void pool_free(Pool *pool) {
+  if (pool == NULL)
+    return;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (unsigned i = 1; i < pool->threads; ++i)
+    pthread_join(pool->tids[i], NULL);
+
+  for (unsigned i = 0; i < pool->threads; ++i)
+    pthread_mutex_destroy(&pool->queues[i].lock);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+
+  free(pool->queues);
+  free(pool->tids);
+  free(pool);
+}
+
+// pool_new - starts threads - 1 threads, returns NULL on failure;
+static inline Pool *pool_new(unsigned threads) {
+  Pool *pool = calloc(1, sizeof(Pool));
+  if (pool == NULL)
+    return NULL;
+
+  pool->tids = calloc(threads, sizeof(pthread_t));
+  pool->queues = aligned_alloc(alignof(Pool_Queue), threads * sizeof(Pool_Queue));
+  if (pool->tids == NULL || pool->queues == NULL) {
+    free(pool->tids);
+    free(pool->queues);
+    free(pool);
+    return NULL;
+  }
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+
+  pool->threads = 1;
+  pthread_mutex_init(&pool->queues[0].lock, NULL);
+
+  for (unsigned i = 1; i < threads; ++i) {
+    Pool_Worker *arg = malloc(sizeof(Pool_Worker));
+    if (arg == NULL) {
+      pool_free(pool);
+      return NULL;
+    }
+
+    *arg = (Pool_Worker){pool, i};
+    pthread_mutex_init(&pool->queues[i].lock, NULL);
+    if (pthread_create(&pool->tids[i], NULL, pool_main, arg) != 0) {
+      pthread_mutex_destroy(&pool->queues[i].lock);
+      free(arg);
+      pool_free(pool);
+      return NULL;
+    }
+
+    ++pool->threads;
+  }
+
+  return pool;
+}
+
+static inline unsigned pool_threads(const Pool *pool) { return pool->threads; }
+
+// pool_run - runs task for every chunk in [0, chunks);
+static inline void pool_run(Pool *pool, size_t chunks, Pool_Task *task,
+                            void *ctx) {
+  for (unsigned i = 0; i < pool->threads; ++i) {
+    pool->queues[i].begin = chunks * i / pool->threads;
+    pool->queues[i].end = chunks * (i + 1) / pool->threads;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->task = task;
+  pool->ctx = ctx;
+  pool->running = pool->threads - 1;
+  ++pool->generation;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  pool_work(pool, 0);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->running != 0)
+    pthread_cond_wait(&pool->done, &pool->lock);
+  pthread_mutex_unlock(&pool->lock);
+}
+#endif
+
+#endif
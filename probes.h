@@ -0,0 +1,62 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef PROBES_H
+#define PROBES_H
+
+// Static tracepoints (USDT) of provider "mewa", compiled in with
+// HAVE_SYS_SDT_H (make USDT=1). Every probe is a single nop until a tracer
+// attaches to it.
+//
+// | Probe              | Arguments                                        |
+// |:-------------------|:-------------------------------------------------|
+// | `statement__start` | statement number                                 |
+// | `statement__end`   | statement number, error                          |
+// | `parse__done`      | error, number of nodes                           |
+// | `exec__entry`      | number of nodes                                  |
+// | `exec__return`     | error, number of values on stack                 |
+// | `builtin__entry`   | function symbol                                  |
+// | `builtin__return`  | function symbol, error                           |
+// | `reduce__entry`    | function symbol, number of terms                 |
+// | `reduce__return`   | function symbol, error                           |
+// | `fork__entry`      | number of subtrees                               |
+// | `fork__return`     | number of subtrees, error of the first failed one|
+// | `gscope__set`      | symbol                                           |
+// | `gscope__miss`     | symbol                                           |
+//
+// Symbols are numbers given to identifiers by the interner in order of their
+// first appearance, builtins come first in order of their enumeration in
+// libmewa.c. Example of execution latency histogram:
+//
+//   bpftrace -e 'usdt:./bin/mewa:mewa:exec__entry { @s[tid] = nsecs; }
+//     usdt:./bin/mewa:mewa:exec__return /@s[tid]/ {
+//       @ns = hist(nsecs - @s[tid]); delete(@s[tid]); }'
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define PROBE1(name, a) DTRACE_PROBE1(mewa, name, a)
+#define PROBE2(name, a, b) DTRACE_PROBE2(mewa, name, a, b)
+#else
+#define PROBE1(name, a)
+#define PROBE2(name, a, b)
+#endif
+
+#endif
@@ -0,0 +1,457 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+// server - evaluates newline-framed expressions received over a Unix socket.
+//
+// Every line is compiled and evaluated by the handle of its connection, and
+// is answered by exactly one line, so clients may pipeline requests:
+//
+//   = 1 6i            number, real and imaginary parts
+//   = true            boolean, or its probability
+//   =                 statement without value
+//   ! ERR_NAME 1:3    compilation error at row:col
+//   ! ERR_NAME        evaluation error
+//
+// Variables assigned by a connection live until it is closed. Handles are
+// taken from a pool created and warmed up before the first connection.
+
+#include "config.h"
+
+#include "mewa.h"
+
+#include "dtoa.h"
+#include "histogram.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//=:server:connection
+
+typedef struct {
+  int fd;
+  Mewa *m;
+
+  // input is discarded up to the next newline after a too long line;
+  bool discarding;
+  uint32_t events;
+
+  size_t in_len;
+  char in[SERVER_LINE_MAX];
+
+  size_t out_off;
+  size_t out_len;
+  size_t out_cap;
+  char *out;
+} Connection;
+
+typedef struct {
+  int listen_fd;
+  int signal_fd;
+  int epoll_fd;
+
+  size_t pool_len;
+  Mewa *pool[SERVER_POOL_SIZE];
+
+  Histogram latency;
+} Server;
+
+static inline void conn_reserve(Connection *c, size_t n) {
+  if (c->out_len + n <= c->out_cap)
+    return;
+
+  if (c->out_off != 0) {
+    memmove(c->out, &c->out[c->out_off], c->out_len - c->out_off);
+    c->out_len -= c->out_off;
+    c->out_off = 0;
+
+    if (c->out_len + n <= c->out_cap)
+      return;
+  }
+
+  size_t cap = c->out_cap ? c->out_cap : SERVER_LINE_MAX;
+  while (cap < c->out_len + n)
+    cap *= 2;
+
+  if ((c->out = realloc(c->out, cap)) == NULL)
+    FATAL("cannot allocate reply buffer\n");
+  c->out_cap = cap;
+}
+
+static inline void conn_write(Connection *c, const char *s, size_t n) {
+  conn_reserve(c, n);
+  memcpy(&c->out[c->out_len], s, n);
+  c->out_len += n;
+}
+
+static inline void conn_str(Connection *c, const char *s) {
+  conn_write(c, s, strlen(s));
+}
+
+static inline void conn_dbl(Connection *c, double v) {
+  conn_reserve(c, DT_BUF_SIZE);
+  c->out_len += dt_format(&c->out[c->out_len], v);
+}
+
+//=:server:reply
+
+static inline void conn_reply_value(Connection *c, const Mewa_Value *value) {
+  conn_str(c, value->type == MEWA_NONE ? "=" : "= ");
+
+  switch (value->type) {
+  case MEWA_NUMBER:
+    if (value->real != 0 || value->imag == 0)
+      conn_dbl(c, value->real);
+    if (value->real != 0 && value->imag != 0)
+      conn_write(c, " ", 1);
+    if (value->imag != 0) {
+      conn_dbl(c, value->imag);
+      conn_write(c, "i", 1);
+    }
+    break;
+  case MEWA_BOOL:
+    if (value->real == 0 || value->real == 1)
+      conn_str(c, value->real == 0 ? "false" : "true");
+    else
+      conn_dbl(c, value->real);
+    break;
+  case MEWA_NONE:
+    break;
+  }
+
+  conn_write(c, "\n", 1);
+}
+
+static inline void conn_reply_error(Connection *c, int code,
+                                    const Mewa_Error *err) {
+  char buf[64];
+
+  conn_str(c, "! ");
+  conn_str(c, mewa_strerror(code));
+  if (err != NULL) {
+    snprintf(buf, sizeof buf, " %zu:%zu", err->row, err->col);
+    conn_str(c, buf);
+  }
+  conn_write(c, "\n", 1);
+}
+
+// conn_eval - answers one line, which is not terminated;
+static inline void conn_eval(Server *s, Connection *c, const char *line,
+                             size_t len) {
+  uint64_t start = hist_now();
+
+  if (len != 0 && line[len - 1] == '\r')
+    --len;
+
+  Mewa_Program *program;
+  int err = mewa_compile(c->m, line, len, &program);
+  if (err != MEWA_OK) {
+    conn_reply_error(c, err, mewa_error(c->m));
+  } else {
+    Mewa_Value value;
+    if ((err = mewa_eval(c->m, program, &value)) == MEWA_OK)
+      conn_reply_value(c, &value);
+    else
+      conn_reply_error(c, err, NULL);
+
+    mewa_program_free(program);
+  }
+
+  hist_add(&s->latency, hist_now() - start);
+}
+
+//=:server:pool
+
+static inline Mewa *server_acquire(Server *s) {
+  if (s->pool_len != 0)
+    return s->pool[--s->pool_len];
+
+  Mewa *m = mewa_new();
+  if (m == NULL)
+    FATAL("cannot allocate evaluation context\n");
+  return m;
+}
+
+static inline void server_release(Server *s, Mewa *m) {
+  if (s->pool_len == SERVER_POOL_SIZE) {
+    mewa_free(m);
+    return;
+  }
+
+  mewa_reset(m);
+  s->pool[s->pool_len++] = m;
+}
+
+// server_warm - fills pool with handles whose buffers are already allocated;
+static inline void server_warm(Server *s) {
+  while (s->pool_len < SERVER_POOL_SIZE) {
+    Mewa *m = mewa_new();
+    if (m == NULL)
+      FATAL("cannot allocate evaluation context\n");
+
+    Mewa_Program *program;
+    Mewa_Value value;
+    if (mewa_compile(m, "0", 1, &program) == MEWA_OK) {
+      mewa_eval(m, program, &value);
+      mewa_program_free(program);
+    }
+
+    s->pool[s->pool_len++] = m;
+  }
+}
+
+//=:server:events
+
+static inline void server_watch(Server *s, int op, int fd, uint32_t events,
+                                void *ptr) {
+  struct epoll_event ev = {.events = events, .data.ptr = ptr};
+  if (epoll_ctl(s->epoll_fd, op, fd, &ev) == -1)
+    PFATAL("cannot watch descriptor");
+}
+
+static inline void conn_close(Server *s, Connection *c) {
+  epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+  close(c->fd);
+
+  server_release(s, c->m);
+  free(c->out);
+  free(c);
+}
+
+// conn_update - sends pending replies and chooses events to wait for. Reading
+// pauses while client does not take its replies. Returns false when
+// connection is broken;
+static inline bool conn_update(Server *s, Connection *c) {
+  while (c->out_off < c->out_len) {
+    ssize_t n = send(c->fd, &c->out[c->out_off], c->out_len - c->out_off,
+                     MSG_NOSIGNAL);
+    if (n == -1) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+      return false;
+    }
+
+    c->out_off += n;
+  }
+
+  if (c->out_off == c->out_len)
+    c->out_off = c->out_len = 0;
+
+  size_t pending = c->out_len - c->out_off;
+  uint32_t events = pending < SERVER_OUTPUT_MAX ? EPOLLIN : 0;
+  if (pending != 0)
+    events |= EPOLLOUT;
+
+  if (events != c->events) {
+    server_watch(s, EPOLL_CTL_MOD, c->fd, events, c);
+    c->events = events;
+  }
+
+  return true;
+}
+
+// conn_read - reads available input and answers its complete lines. Returns
+// false when connection is closed by client;
+static inline bool conn_read(Server *s, Connection *c) {
+  ssize_t n = read(c->fd, &c->in[c->in_len], SERVER_LINE_MAX - c->in_len);
+  if (n == -1)
+    return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+  if (n == 0)
+    return false;
+
+  size_t begin = 0, end = c->in_len + n;
+  for (size_t i = c->in_len; i < end; ++i) {
+    if (c->in[i] != '\n')
+      continue;
+
+    if (!c->discarding)
+      conn_eval(s, c, &c->in[begin], i - begin);
+
+    c->discarding = false;
+    begin = i + 1;
+  }
+
+  if (begin == 0 && end == SERVER_LINE_MAX) {
+    if (!c->discarding)
+      conn_str(c, "! line is too long\n");
+
+    c->discarding = true;
+    begin = end;
+  }
+
+  memmove(c->in, &c->in[begin], end - begin);
+  c->in_len = end - begin;
+  return true;
+}
+
+static inline void server_accept(Server *s) {
+  while (true) {
+    int fd = accept(s->listen_fd, NULL, NULL);
+    if (fd == -1) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        perror("cannot accept connection");
+      return;
+    }
+
+    if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1) {
+      close(fd);
+      continue;
+    }
+
+    Connection *c = calloc(1, sizeof(Connection));
+    if (c == NULL)
+      FATAL("cannot allocate connection\n");
+
+    c->fd = fd;
+    c->m = server_acquire(s);
+    c->events = EPOLLIN;
+    server_watch(s, EPOLL_CTL_ADD, fd, c->events, c);
+  }
+}
+
+// server_signal - returns false when server must stop;
+static inline bool server_signal(Server *s) {
+  struct signalfd_siginfo info;
+  if (read(s->signal_fd, &info, sizeof info) != sizeof info)
+    return true;
+
+  hist_print(&s->latency, stderr, "latency");
+  return info.ssi_signo == SIGUSR1;
+}
+
+//=:server:main
+
+static inline int server_listen(const char *path) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof addr.sun_path)
+    FATAL("socket path is too long: %s\n", path);
+  strcpy(addr.sun_path, path);
+
+  // only a socket left by previous server is replaced;
+  struct stat st;
+  if (lstat(path, &st) == 0) {
+    if (!S_ISSOCK(st.st_mode))
+      FATAL("%s exists and is not a socket\n", path);
+    unlink(path);
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd == -1)
+    PFATAL("cannot create socket");
+  if (bind(fd, (struct sockaddr *)&addr, sizeof addr) == -1)
+    PFATAL("cannot bind socket");
+  if (listen(fd, SERVER_BACKLOG) == -1)
+    PFATAL("cannot listen on socket");
+
+  return fd;
+}
+
+// serve - answers connections to socket at path until SIGINT or SIGTERM.
+// SIGUSR1 prints latency histogram without stopping;
+static inline void serve(const char *path) {
+  Server s = {0};
+
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGUSR1);
+  if (sigprocmask(SIG_BLOCK, &mask, NULL) == -1)
+    PFATAL("cannot block signals");
+  if ((s.signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC)) == -1)
+    PFATAL("cannot create signalfd");
+
+  server_warm(&s);
+
+  s.listen_fd = server_listen(path);
+  if ((s.epoll_fd = epoll_create1(EPOLL_CLOEXEC)) == -1)
+    PFATAL("cannot create epoll");
+
+  server_watch(&s, EPOLL_CTL_ADD, s.listen_fd, EPOLLIN, &s.listen_fd);
+  server_watch(&s, EPOLL_CTL_ADD, s.signal_fd, EPOLLIN, &s.signal_fd);
+
+  struct epoll_event events[SERVER_MAX_EVENTS];
+  bool running = true;
+
+  while (running) {
+    int n = epoll_wait(s.epoll_fd, events, SERVER_MAX_EVENTS, -1);
+    if (n == -1) {
+      if (errno == EINTR)
+        continue;
+      PFATAL("cannot wait for events");
+    }
+
+    for (int i = 0; i < n; ++i) {
+      void *ptr = events[i].data.ptr;
+
+      if (ptr == &s.listen_fd) {
+        server_accept(&s);
+        continue;
+      }
+
+      if (ptr == &s.signal_fd) {
+        running = server_signal(&s);
+        continue;
+      }
+
+      Connection *c = ptr;
+      bool open = true;
+
+      if (events[i].events & EPOLLIN)
+        open = conn_read(&s, c);
+      else if (events[i].events & (EPOLLERR | EPOLLHUP))
+        open = false;
+
+      // replies to the last lines are still sent to a half-closed client;
+      if (!conn_update(&s, c) || !open)
+        conn_close(&s, c);
+    }
+  }
+
+  // connections are left to the operating system;
+  unlink(path);
+  close(s.listen_fd);
+  close(s.epoll_fd);
+  close(s.signal_fd);
+
+  while (s.pool_len != 0)
+    mewa_free(s.pool[--s.pool_len]);
+}
+
+#endif
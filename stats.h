@@ -0,0 +1,109 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+//=:stats:stats
+
+typedef enum {
+  SP_READ,
+  SP_LEX,
+  SP_PARSE,
+  SP_EXEC,
+  SP_COUNT,
+} Stats_Phase;
+
+// rules of simplification of programs;
+typedef enum {
+  SR_IDENTITY,
+  SR_NEGATION,
+  SR_RECIPROCAL,
+  SR_POWER,
+  SR_POLY,
+  SR_COUNT,
+} Stats_Rule;
+
+// wall time of every phase includes time of phases it calls:
+// parse includes lex and lex includes read.
+typedef struct {
+  bool enabled;
+  bool json;
+
+  uint64_t wall_ns[SP_COUNT];
+  uint64_t front_cpu_ns;
+  uint64_t exec_cpu_ns;
+
+  uint64_t tokens;
+  uint64_t nodes;
+  uint64_t rules[SR_COUNT];
+  size_t st_hwm;
+  size_t st_depth;
+
+  uint64_t allocs;
+  uint64_t alloc_bytes;
+} Stats;
+
+// macros take a pointer to Stats of the handle that is instrumented;
+#ifdef NSTATS
+#define STATS_INC(s, field)
+#define STATS_ADD(s, field, v)
+#define STATS_MAX(s, field, v)
+#define STATS_ALLOC(s, sz)
+#define STATS_CLOCK_BEGIN(s, var, clk)
+#define STATS_CLOCK_END(s, var, clk, dst)
+#else
+static inline uint64_t stats_now(clockid_t clk) {
+  struct timespec ts;
+  clock_gettime(clk, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+#define STATS_INC(s, field) (++(s)->field)
+
+#define STATS_ADD(s, field, v) ((s)->field += (v))
+
+#define STATS_MAX(s, field, v) \
+  do {                         \
+    if ((v) > (s)->field)      \
+      (s)->field = (v);        \
+  } while (0)
+
+#define STATS_ALLOC(s, sz) (++(s)->allocs, (s)->alloc_bytes += (sz))
+
+// clocks are read only when statistics were requested at runtime;
+#define STATS_CLOCK_BEGIN(s, var, clk) \
+  uint64_t var = (s)->enabled ? stats_now(clk) : 0
+
+#define STATS_CLOCK_END(s, var, clk, dst) \
+  do {                                    \
+    if ((s)->enabled)                     \
+      (s)->dst += stats_now(clk) - var;   \
+  } while (0)
+#endif
+
+#endif
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+# bench.sh - times Mewa on corpora produced by mewa-gen.
+#
+# Every corpus is evaluated REPEAT times and the best wall time is reported.
+
+set -eu
+
+MEWA=${MEWA:-./bin/mewa}
+GEN=${GEN:-./bin/mewa-gen}
+SEED=${SEED:-1}
+REPEAT=${REPEAT:-5}
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# bench NAME GEN_ARGS... - generates corpus and reports best evaluation time;
+bench() {
+  local name=$1 best= start end us
+  shift
+
+  "$GEN" -s "$SEED" "$@" >"$tmp/$name"
+
+  for ((r = 0; r < REPEAT; ++r)); do
+    start=$(date +%s%N)
+    "$MEWA" -f "$tmp/$name" >/dev/null
+    end=$(date +%s%N)
+    us=$(((end - start) / 1000))
+    if [ -z "$best" ] || [ $us -lt $best ]; then
+      best=$us
+    fi
+  done
+
+  printf '%-8s %12d bytes %10d us\n' "$name" "$(wc -c <"$tmp/$name")" "$best"
+}
+
+bench sum   -n 400000 sum
+bench paren -n 1000 -d 2000 paren
+bench fac   -n 20000 -d 6 fac
+bench let   -n 200 let
+bench cmx   -n 100000 cmx
+bench mix   -n 100000 -d 24 -m '++--**/' mix
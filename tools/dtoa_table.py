@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+# dtoa_table.py - generates dtoa_table.h, the 128-bit powers of 5 used by
+# dt_d2d. Run from the repository root: ./tools/dtoa_table.py > dtoa_table.h
+
+POW5_INV_BITCOUNT = 125
+POW5_BITCOUNT = 125
+POW5_INV_TABLE_SIZE = 342
+POW5_TABLE_SIZE = 326
+MASK64 = (1 << 64) - 1
+
+HEADER = """\
+/******************************************************************************\\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\\******************************************************************************/
+
+// generated by tools/dtoa_table.py, do not edit
+
+#ifndef DTOA_TABLE_H
+#define DTOA_TABLE_H
+
+#include <stdint.h>
+
+#define DT_POW5_INV_BITCOUNT ({inv_bits})
+#define DT_POW5_BITCOUNT ({bits})
+"""
+
+
+def table(name, size, values):
+    print(f"\nstatic const uint64_t {name}[{size}][2] = {{")
+    for v in values:
+        print(f"    {{0x{v & MASK64:016x}u, 0x{v >> 64:016x}u}},")
+    print("};")
+
+
+def inv(i):
+    pow5 = 5**i
+    return (1 << (pow5.bit_length() - 1 + POW5_INV_BITCOUNT)) // pow5 + 1
+
+
+def split(i):
+    pow5 = 5**i
+    shift = pow5.bit_length() - POW5_BITCOUNT
+    return pow5 >> shift if shift >= 0 else pow5 << -shift
+
+
+print(HEADER.format(inv_bits=POW5_INV_BITCOUNT, bits=POW5_BITCOUNT), end="")
+table("DT_POW5_INV_SPLIT", POW5_INV_TABLE_SIZE,
+      (inv(i) for i in range(POW5_INV_TABLE_SIZE)))
+table("DT_POW5_SPLIT", POW5_TABLE_SIZE,
+      (split(i) for i in range(POW5_TABLE_SIZE)))
+print("\n#endif")
@@ -0,0 +1,371 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+// mewa-gen - seeded generator of synthetic workloads for benchmarks and
+// regression tests.
+//
+// Writes an expression of the requested KIND to stdout. With -c the value
+// the expression must evaluate to is written to stderr in Mewa's own result
+// format, so a driver can compare it with Mewa's output.
+
+#include <complex.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FATAL(...)                              \
+  {                                             \
+    fprintf(stderr, "mewa-gen: " __VA_ARGS__);  \
+    exit(EXIT_FAILURE);                         \
+  }
+
+//=:gen:random
+
+// xorshift64* - small, fast and identical on every platform.
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+// rng_range - returns uniformly distributed number in [lo, hi];
+static long rng_range(long lo, long hi) {
+  return lo + (long)(rng_next() % (uint64_t)(hi - lo + 1));
+}
+
+//=:gen:options
+
+typedef enum {
+  GK_SUM,
+  GK_PAREN,
+  GK_FAC,
+  GK_LET,
+  GK_CMX,
+  GK_MIX,
+} Gen_Kind;
+
+static const char *gk_names[] = {
+    [GK_SUM] = "sum",
+    [GK_PAREN] = "paren",
+    [GK_FAC] = "fac",
+    [GK_LET] = "let",
+    [GK_CMX] = "cmx",
+    [GK_MIX] = "mix",
+};
+
+typedef struct {
+  Gen_Kind kind;
+  uint64_t seed;
+  long size;
+  long depth;
+  long name_len;
+  const char *mix;
+  bool check;
+} Gen_Options;
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+      "usage: %s [-s SEED] [-n SIZE] [-d DEPTH] [-l LEN] [-m OPS] [-c] KIND\n"
+      "\n"
+      "kinds:\n"
+      "  sum    SIZE-term sum of integer literals\n"
+      "  paren  DEPTH nested parentheses around a SIZE-term sum\n"
+      "  fac    SIZE multifactorials with up to DEPTH '!' each\n"
+      "  let    SIZE variables bound by LET, then summed\n"
+      "  cmx    SIZE complex literals combined by '+', '-' and '*'\n"
+      "  mix    SIZE-leaf tree of at most DEPTH levels over OPS\n"
+      "\n"
+      "options:\n"
+      "  -s SEED   random seed (default: 1)\n"
+      "  -n SIZE   number of terms (default: 1000)\n"
+      "  -d DEPTH  nesting depth (default: 8)\n"
+      "  -l LEN    least length of variable names of 'let' (default: 2)\n"
+      "  -m OPS    operators used by 'mix', repeat one to raise its weight\n"
+      "            (default: \"++--**/^\", available: \"+-*/^\")\n"
+      "  -c        write expected result to stderr\n",
+      argv0);
+  exit(EXIT_FAILURE);
+}
+
+static long parse_long(const char *s, const char *what) {
+  char *end;
+  long v = strtol(s, &end, 0);
+  if (*s == '\0' || *end != '\0' || v < 0)
+    FATAL("invalid %s: %s\n", what, s);
+  return v;
+}
+
+//=:gen:output
+
+static void out_lit(long v) { printf("%ld", v); }
+
+static void out_cmx(double complex v) {
+  if (creal(v) != 0 && cimag(v) != 0) {
+    fprintf(stderr, "%lf %lfi\n", creal(v), cimag(v));
+  } else if (creal(v) == 0 && cimag(v) == 0) {
+    fprintf(stderr, "0\n");
+  } else if (creal(v) != 0) {
+    fprintf(stderr, "%lf\n", creal(v));
+  } else {
+    fprintf(stderr, "%lfi\n", cimag(v));
+  }
+}
+
+//=:gen:kinds
+
+static double complex gen_sum(long n) {
+  double complex rt = 0;
+
+  for (long i = 0; i < n; ++i) {
+    long v = rng_range(1, 9999);
+    if (i != 0)
+      printf(" + ");
+    out_lit(v);
+    rt += v;
+  }
+
+  return rt;
+}
+
+// paren - pushes the parser's p0c counter up to depth before the payload;
+static double complex gen_paren(long n, long depth) {
+  for (long i = 0; i < depth; ++i)
+    putchar('(');
+
+  double complex rt = gen_sum(n);
+
+  for (long i = 0; i < depth; ++i)
+    putchar(')');
+
+  return rt;
+}
+
+static double multifactorial(long base, long step) {
+  double rt = 1;
+
+  for (long i = base; i > 0; i -= step)
+    rt *= i;
+
+  return rt;
+}
+
+static double complex gen_fac(long n, long depth) {
+  double complex rt = 0;
+
+  for (long i = 0; i < n; ++i) {
+    long step = rng_range(1, depth < 1 ? 1 : depth);
+    long base = rng_range(1, 12);
+
+    if (i != 0)
+      printf(" + ");
+    out_lit(base);
+    for (long j = 0; j < step; ++j)
+      putchar('!');
+
+    rt += multifactorial(base, step);
+  }
+
+  return rt;
+}
+
+// out_var - writes name of variable i, padded by 'v' to len characters;
+static void out_var(long i, long len) {
+  int digits = snprintf(NULL, 0, "%ld", i);
+
+  putchar('v');
+  for (long k = digits + 1; k < len; ++k)
+    putchar('v');
+  printf("%ld", i);
+}
+
+static double complex gen_let(long n, long name_len) {
+  double complex rt = 0;
+
+  for (long i = 0; i < n; ++i) {
+    long v = rng_range(1, 9999);
+    out_var(i, name_len);
+    printf(" = ");
+    out_lit(v);
+    printf("; ");
+    rt += v;
+  }
+
+  for (long i = 0; i < n; ++i) {
+    if (i != 0)
+      printf(" + ");
+    out_var(i, name_len);
+  }
+
+  return rt;
+}
+
+static double complex gen_cmx(long n) {
+  double complex acc = 0, term = 0;
+
+  for (long i = 0; i < n; ++i) {
+    long re = rng_range(1, 99);
+    long im = rng_range(1, 99);
+    double complex v = re + im * I;
+    char op = i == 0 ? '+' : "+-*"[rng_range(0, 2)];
+
+    if (i != 0)
+      printf(" %c ", op);
+    printf("(%ld + %ldi)", re, im);
+
+    // multiplication binds tighter, so it only extends the current term;
+    switch (op) {
+    case '+': acc += term; term = v; break;
+    case '-': acc += term; term = -v; break;
+    case '*': term *= v; break;
+    }
+  }
+
+  return acc + term;
+}
+
+// gen_mix_node - when positive is set, subtraction is replaced by addition,
+// so the subtree can safely be used as a divisor;
+static double complex gen_mix_node(const char *ops, size_t ops_len, long n,
+                                   long depth, bool positive) {
+  if (n <= 1 || depth <= 0) {
+    long v = rng_range(1, 9);
+    out_lit(v);
+    return v;
+  }
+
+  char op = ops[rng_range(0, ops_len - 1)];
+  if (positive && op == '-')
+    op = '+';
+
+  if (op == '^') {
+    // exponent is kept small and literal, so results stay finite;
+    long e = rng_range(1, 3);
+    putchar('(');
+    double complex lhs = gen_mix_node(ops, ops_len, n, depth - 1, positive);
+    printf(")^%ld", e);
+
+    // powers of integer exponents are multiplied, as mewa does;
+    double complex v = lhs;
+    for (long i = 1; i < e; ++i)
+      v *= lhs;
+    return v;
+  }
+
+  long ln = rng_range(1, n - 1);
+
+  putchar('(');
+  double complex lhs = gen_mix_node(ops, ops_len, ln, depth - 1, positive);
+  printf(" %c ", op);
+  double complex rhs =
+      gen_mix_node(ops, ops_len, n - ln, depth - 1, positive || op == '/');
+  putchar(')');
+
+  switch (op) {
+  case '+': return lhs + rhs;
+  case '-': return lhs - rhs;
+  case '*': return lhs * rhs;
+  case '/': return lhs / rhs;
+  }
+
+  FATAL("unknown operator: '%c'\n", op);
+}
+
+static double complex gen_mix(const char *ops, long n, long depth) {
+  size_t ops_len = strlen(ops);
+
+  if (ops_len == 0)
+    FATAL("operator mix is empty\n");
+  for (size_t i = 0; i < ops_len; ++i)
+    if (strchr("+-*/^", ops[i]) == NULL)
+      FATAL("unknown operator: '%c'\n", ops[i]);
+
+  return gen_mix_node(ops, ops_len, n, depth, false);
+}
+
+//=:gen:main
+
+int main(int argc, char *argv[]) {
+  Gen_Options opt = {
+      .seed = 1,
+      .size = 1000,
+      .depth = 8,
+      .name_len = 2,
+      .mix = "++--**/^",
+  };
+
+  int c;
+  while ((c = getopt(argc, argv, "s:n:d:l:m:c")) != -1) {
+    switch (c) {
+    case 's': opt.seed = parse_long(optarg, "seed"); break;
+    case 'n': opt.size = parse_long(optarg, "size"); break;
+    case 'd': opt.depth = parse_long(optarg, "depth"); break;
+    case 'l': opt.name_len = parse_long(optarg, "name length"); break;
+    case 'm': opt.mix = optarg; break;
+    case 'c': opt.check = true; break;
+    default: usage(argv[0]);
+    }
+  }
+
+  if (optind + 1 != argc)
+    usage(argv[0]);
+
+  size_t kinds = sizeof gk_names / sizeof *gk_names;
+  for (opt.kind = 0; opt.kind < kinds; ++opt.kind)
+    if (strcmp(argv[optind], gk_names[opt.kind]) == 0)
+      break;
+  if (opt.kind == kinds)
+    FATAL("unknown kind: %s\n", argv[optind]);
+
+  if (opt.size == 0)
+    FATAL("size must be at least 1\n");
+
+  // seed 0 is a fixed point of xorshift;
+  rng_state = opt.seed ^ 0x9e3779b97f4a7c15ull;
+
+  static char out_buf[1 << 16];
+  setvbuf(stdout, out_buf, _IOFBF, sizeof out_buf);
+
+  double complex rt = 0;
+
+  switch (opt.kind) {
+  case GK_SUM:   rt = gen_sum(opt.size); break;
+  case GK_PAREN: rt = gen_paren(opt.size, opt.depth); break;
+  case GK_FAC:   rt = gen_fac(opt.size, opt.depth); break;
+  case GK_LET:   rt = gen_let(opt.size, opt.name_len); break;
+  case GK_CMX:   rt = gen_cmx(opt.size); break;
+  case GK_MIX:   rt = gen_mix(opt.mix, opt.size, opt.depth); break;
+  }
+
+  putchar('\n');
+  if (fflush(stdout) != 0)
+    FATAL("cannot write output\n");
+
+  if (opt.check)
+    out_cmx(rt);
+
+  return EXIT_SUCCESS;
+}
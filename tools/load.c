@@ -0,0 +1,285 @@
+/******************************************************************************\
+*                                                                              *
+*    Mewa. Math EWAluator.                                                     *
+*    Copyright (C) 2024 Mark Mandriota                                         *
+*                                                                              *
+*    This program is free software: you can redistribute it and/or modify      *
+*    it under the terms of the GNU General Public License as published by      *
+*    the Free Software Foundation, either version 3 of the License, or         *
+*    (at your option) any later version.                                       *
+*                                                                              *
+*    This program is distributed in the hope that it will be useful,           *
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+*    GNU General Public License for more details.                              *
+*                                                                              *
+*    You should have received a copy of the GNU General Public License         *
+*    along with this program.  If not, see <https://www.gnu.org/licenses/>.    *
+*                                                                              *
+\******************************************************************************/
+
+// mewa-load - load generator for `mewa --serve`.
+//
+// Opens connections to the server socket, keeps up to DEPTH requests in
+// flight on each of them and measures time from sending a request to
+// receiving its reply. With -w every reply is compared with the expected one.
+
+#include "../histogram.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define FATAL(...)                               \
+  {                                              \
+    fprintf(stderr, "mewa-load: " __VA_ARGS__);  \
+    exit(EXIT_FAILURE);                          \
+  }
+
+#define LOAD_LINE_MAX (4096)
+
+//=:load:options
+
+typedef struct {
+  long conns;
+  long requests;
+  long depth;
+  const char *expr;
+  const char *want;
+  const char *path;
+} Load_Options;
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+      "usage: %s [-c CONNS] [-n REQUESTS] [-p DEPTH] [-e EXPR] [-w REPLY] "
+      "SOCKET\n"
+      "\n"
+      "options:\n"
+      "  -c CONNS     number of connections (default: 1)\n"
+      "  -n REQUESTS  number of requests over all connections (default: 10000)\n"
+      "  -p DEPTH     requests in flight on a connection (default: 1)\n"
+      "  -e EXPR      expression sent by every request (default: \"1 + 2\")\n"
+      "  -w REPLY     expected reply, mismatches make exit status non-zero\n",
+      argv0);
+  exit(EXIT_FAILURE);
+}
+
+static long parse_long(const char *s, const char *what) {
+  char *end;
+  long v = strtol(s, &end, 0);
+  if (*s == '\0' || *end != '\0' || v <= 0)
+    FATAL("invalid %s: %s\n", what, s);
+  return v;
+}
+
+//=:load:connection
+
+typedef struct {
+  int fd;
+  long quota;
+  long sent;
+  long received;
+
+  // send times of requests in flight, indexed by request number mod depth;
+  uint64_t *sent_at;
+
+  size_t in_len;
+  char in[LOAD_LINE_MAX];
+
+  size_t out_off;
+  size_t out_len;
+  char *out;
+} Load_Conn;
+
+static int load_connect(const char *path) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof addr.sun_path)
+    FATAL("socket path is too long: %s\n", path);
+  strcpy(addr.sun_path, path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (fd == -1 || connect(fd, (struct sockaddr *)&addr, sizeof addr) == -1)
+    FATAL("cannot connect to %s: %s\n", path, strerror(errno));
+
+  return fd;
+}
+
+// load_fill - queues requests until DEPTH of them are in flight;
+static void load_fill(Load_Conn *c, const Load_Options *opt, size_t line_len) {
+  // unsent requests are in flight, so they leave room for the new ones;
+  memmove(c->out, &c->out[c->out_off], c->out_len - c->out_off);
+  c->out_len -= c->out_off;
+  c->out_off = 0;
+
+  uint64_t now = hist_now();
+  while (c->sent < c->quota && c->sent - c->received < opt->depth) {
+    memcpy(&c->out[c->out_len], opt->expr, line_len - 1);
+    c->out[c->out_len + line_len - 1] = '\n';
+    c->out_len += line_len;
+
+    c->sent_at[c->sent % opt->depth] = now;
+    ++c->sent;
+  }
+}
+
+// load_read - accounts received replies and counts mismatched ones;
+static void load_read(Load_Conn *c, const Load_Options *opt, Histogram *h,
+                      long *mismatches) {
+  ssize_t n = read(c->fd, &c->in[c->in_len], LOAD_LINE_MAX - c->in_len);
+  if (n == -1 && (errno == EAGAIN || errno == EINTR))
+    return;
+  if (n <= 0)
+    FATAL("connection closed after %ld of %ld replies\n", c->received,
+        c->quota);
+
+  uint64_t now = hist_now();
+  size_t begin = 0, end = c->in_len + n;
+
+  for (size_t i = c->in_len; i < end; ++i) {
+    if (c->in[i] != '\n')
+      continue;
+
+    if (c->received == c->sent)
+      FATAL("reply without request\n");
+
+    hist_add(h, now - c->sent_at[c->received % opt->depth]);
+    ++c->received;
+
+    size_t len = i - begin;
+    if (opt->want != NULL &&
+        (len != strlen(opt->want) || memcmp(&c->in[begin], opt->want, len))) {
+      if ((*mismatches)++ == 0)
+        fprintf(stderr, "mewa-load: got '%.*s', want '%s'\n", (int)len,
+            &c->in[begin], opt->want);
+    }
+
+    begin = i + 1;
+  }
+
+  if (begin == 0 && end == LOAD_LINE_MAX)
+    FATAL("reply is too long\n");
+
+  memmove(c->in, &c->in[begin], end - begin);
+  c->in_len = end - begin;
+}
+
+static void load_write(Load_Conn *c) {
+  ssize_t n = send(c->fd, &c->out[c->out_off], c->out_len - c->out_off,
+                   MSG_NOSIGNAL);
+  if (n == -1 && (errno == EAGAIN || errno == EINTR))
+    return;
+  if (n == -1)
+    FATAL("cannot send request: %s\n", strerror(errno));
+
+  c->out_off += n;
+}
+
+//=:load:main
+
+int main(int argc, char *argv[]) {
+  Load_Options opt = {
+      .conns = 1,
+      .requests = 10000,
+      .depth = 1,
+      .expr = "1 + 2",
+  };
+
+  int ch;
+  while ((ch = getopt(argc, argv, "c:n:p:e:w:")) != -1) {
+    switch (ch) {
+    case 'c': opt.conns = parse_long(optarg, "number of connections"); break;
+    case 'n': opt.requests = parse_long(optarg, "number of requests"); break;
+    case 'p': opt.depth = parse_long(optarg, "depth"); break;
+    case 'e': opt.expr = optarg; break;
+    case 'w': opt.want = optarg; break;
+    default: usage(argv[0]);
+    }
+  }
+
+  if (optind + 1 != argc)
+    usage(argv[0]);
+  opt.path = argv[optind];
+
+  if (strchr(opt.expr, '\n') != NULL)
+    FATAL("expression must be a single line\n");
+  size_t line_len = strlen(opt.expr) + 1;
+
+  Load_Conn *conns = calloc(opt.conns, sizeof(Load_Conn));
+  struct pollfd *fds = calloc(opt.conns, sizeof(struct pollfd));
+  if (conns == NULL || fds == NULL)
+    FATAL("cannot allocate connections\n");
+
+  for (long i = 0; i < opt.conns; ++i) {
+    Load_Conn *c = &conns[i];
+    c->fd = load_connect(opt.path);
+    c->quota = opt.requests / opt.conns + (i < opt.requests % opt.conns);
+    c->sent_at = malloc(opt.depth * sizeof(uint64_t));
+    c->out = malloc(opt.depth * line_len);
+    if (c->sent_at == NULL || c->out == NULL)
+      FATAL("cannot allocate connections\n");
+
+    fds[i].fd = c->fd;
+  }
+
+  Histogram latency = {0};
+  long mismatches = 0, done = 0;
+  uint64_t start = hist_now();
+
+  while (done < opt.requests) {
+    for (long i = 0; i < opt.conns; ++i) {
+      Load_Conn *c = &conns[i];
+      load_fill(c, &opt, line_len);
+      if (c->out_off < c->out_len)
+        load_write(c);
+
+      fds[i].events = c->received < c->quota ? POLLIN : 0;
+      if (c->out_off < c->out_len)
+        fds[i].events |= POLLOUT;
+    }
+
+    if (poll(fds, opt.conns, -1) == -1) {
+      if (errno == EINTR)
+        continue;
+      FATAL("cannot poll: %s\n", strerror(errno));
+    }
+
+    for (long i = 0; i < opt.conns; ++i) {
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+        long received = conns[i].received;
+        load_read(&conns[i], &opt, &latency, &mismatches);
+        done += conns[i].received - received;
+      }
+
+      if (fds[i].revents & POLLOUT)
+        load_write(&conns[i]);
+    }
+  }
+
+  double elapsed = (hist_now() - start) / 1e9;
+  printf("%ld requests over %ld connections in %.3fs, %.0f requests/s\n",
+      opt.requests, opt.conns, elapsed, opt.requests / elapsed);
+  hist_print(&latency, stdout, "latency");
+
+  for (long i = 0; i < opt.conns; ++i) {
+    close(conns[i].fd);
+    free(conns[i].sent_at);
+    free(conns[i].out);
+  }
+  free(conns);
+  free(fds);
+
+  if (mismatches != 0) {
+    fprintf(stderr, "mewa-load: %ld of %ld replies mismatched\n", mismatches,
+        opt.requests);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
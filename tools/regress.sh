@@ -0,0 +1,225 @@
+#!/bin/sh
+# regress.sh - evaluates corpora produced by mewa-gen and compares Mewa's
+# results with the values predicted by the generator.
+
+MEWA=${MEWA:-./bin/mewa}
+GEN=${GEN:-./bin/mewa-gen}
+LOAD=${LOAD:-./bin/mewa-load}
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+total=0
+failed=0
+
+# check NAME GEN_ARGS... - generates corpus, evaluates it and compares result;
+check() {
+  name=$1
+  shift
+  total=$((total + 1))
+
+  if ! "$GEN" -c "$@" >"$tmp/in" 2>"$tmp/want"; then
+    echo "FAIL $name: generator failed"
+    failed=$((failed + 1))
+    return
+  fi
+
+  "$MEWA" -f "$tmp/in" >"$tmp/out" 2>"$tmp/err"
+  status=$?
+
+  got=$(sed 's/\x1b\[[0-9;]*m//g; s/ +\/- .*//' "$tmp/out" | sed -n 's/^= //p')
+  want=$(cat "$tmp/want")
+
+  if [ $status -ne 0 ] || ! awk -v a="$got" -v b="$want" '
+    BEGIN {
+      n = split(a, x, " ")
+      if (n == 0 || n != split(b, y, " "))
+        exit 1
+      for (i = 1; i <= n; ++i) {
+        if (x[i] == y[i])
+          continue
+        d = x[i] - y[i]
+        s = y[i] + 0
+        if ((d < 0 ? -d : d) > 1e-6 * (s < 0 ? -s : s) + 1e-6)
+          exit 1
+      }
+    }'; then
+    echo "FAIL $name: got '$got', want '$want' (status $status)"
+    sed 's/^/  /' "$tmp/err"
+    failed=$((failed + 1))
+    return
+  fi
+
+  echo "ok   $name"
+}
+
+for n in 1 10 10000; do
+  check "sum/n=$n" -n $n sum
+done
+
+for d in 1 100 1000; do
+  check "paren/d=$d" -n 10 -d $d paren
+done
+
+for d in 1 2 3 4 5 6; do
+  check "fac/d=$d" -s $d -n 50 -d $d fac
+done
+
+# tokens split between reading pages;
+check "fac/pages" -n 5000 -d 6 fac
+
+for n in 1 50 200; do
+  check "let/n=$n" -n $n let
+done
+
+# identifiers longer than a machine word;
+check "let/long" -n 200 -l 40 let
+
+for n in 1 10 500; do
+  check "cmx/n=$n" -n $n cmx
+done
+
+for s in 1 2 3 4 5; do
+  check "mix/+*/s=$s" -s $s -n 200 -d 12 -m '++*' mix
+  check "mix/all/s=$s" -s $s -n 200 -d 12 mix
+done
+
+# check_binary NAME EXPR REAL IMAG TAG - evaluates EXPR in binary output mode;
+check_binary() {
+  name=$1
+  total=$((total + 1))
+
+  "$MEWA" --binary "$2" >"$tmp/out" 2>"$tmp/err"
+  status=$?
+
+  # records are little-endian, od reads them in host order;
+  got="$(od -An -v -tf8 -N16 "$tmp/out" | tr -s ' \n' ' ')$(od -An -v -tu4 -j20 -N4 "$tmp/out" | tr -d ' \n')"
+  size=$(wc -c <"$tmp/out" | tr -d ' ')
+
+  if [ $status -ne 0 ] || [ "$size" -ne 24 ] ||
+    ! echo "$got" | awk -v r="$3" -v i="$4" -v t="$5" \
+      '{ exit !($1 == r && $2 == i && $3 == t) }'; then
+    echo "FAIL $name: got '$got' ($size bytes), want '$3 $4 $5' (status $status)"
+    failed=$((failed + 1))
+    return
+  fi
+
+  echo "ok   $name"
+}
+
+if [ "$(printf '\001\000' | od -An -tu2 | tr -d ' ')" = 1 ]; then
+  check_binary "binary/cmx" '1 + 2i*3' 1 6 1
+  check_binary "binary/prb" '1 > 2' 0 0 2
+  check_binary "binary/none" 'x = 3' 0 0 0
+  check_binary "binary/simplify/add" '0 + 1' 1 0 1
+  check_binary "binary/simplify/mul" '5*1' 5 0 1
+fi
+
+# check_grid NAME BYTES CKSUM ARGS... - evaluates grid serially and on
+# threads, outputs must be equal, of BYTES bytes and of CKSUM by cksum(1),
+# which is taken of output checked to hold the values of expression;
+check_grid() {
+  name=$1
+  bytes=$2
+  sum=$3
+  shift 3
+  total=$((total + 1))
+
+  "$MEWA" --threads=1 "$@" >"$tmp/want" 2>"$tmp/err" &&
+    "$MEWA" --threads=4 "$@" >"$tmp/out" 2>>"$tmp/err"
+  status=$?
+  size=$(wc -c <"$tmp/out" | tr -d ' ')
+  got=$(cksum <"$tmp/out" | cut -d ' ' -f 1)
+
+  if [ $status -ne 0 ] || [ "$size" -ne "$bytes" ] || [ "$got" != "$sum" ] ||
+    ! cmp -s "$tmp/want" "$tmp/out"; then
+    echo "FAIL $name: $size bytes of cksum $got, want $bytes of $sum" \
+      "(status $status)"
+    sed 's/^/  /' "$tmp/err"
+    failed=$((failed + 1))
+    return
+  fi
+
+  echo "ok   $name"
+}
+
+check_grid "grid/csv" 37139 433424038 --grid=x=-1:1:1001 'x^3'
+check_grid "grid/binary" 1440000 3252821391 \
+  --grid=x=-2:2:300,y=-1:1:200 --binary 'x*y'
+check_grid "grid/ppm" 250764 1983863021 \
+  --grid=z=-2:2:333,z=-2:2:251 --ppm '1/z'
+check_grid "grid/simplify/add" 60 3923555883 --grid=x=-2:2:5 '0 + x'
+check_grid "grid/simplify/mul" 60 3923555883 --grid=x=-2:2:5 '1*x'
+check_grid "grid/poly/coef" 78 3969264012 --grid=x=-3:3:7 '2*x^2 + 3*x + 1'
+check_grid "grid/poly/var" 84 726923228 --grid=x=-3:3:7 'x/2 + x^2'
+
+# check_serve NAME LOAD_ARGS... - runs load generator against `mewa --serve`;
+check_serve() {
+  name=$1
+  shift
+  total=$((total + 1))
+
+  "$MEWA" --serve "$tmp/sock" 2>"$tmp/err" &
+  pid=$!
+
+  tries=0
+  while [ ! -S "$tmp/sock" ] && [ $tries -lt 50 ]; do
+    sleep 0.1
+    tries=$((tries + 1))
+  done
+
+  "$LOAD" "$@" "$tmp/sock" >"$tmp/out" 2>>"$tmp/err"
+  status=$?
+
+  kill "$pid"
+  wait "$pid"
+  served=$?
+
+  # server built with sanitizers exits with failure on leaks;
+  if [ $status -ne 0 ] || [ $served -ne 0 ] || [ -e "$tmp/sock" ]; then
+    echo "FAIL $name: status $status, server status $served"
+    sed 's/^/  /' "$tmp/err"
+    failed=$((failed + 1))
+    return
+  fi
+
+  echo "ok   $name"
+}
+
+# check_threads NAME WANT EXPR - evaluates EXPR serially and on threads, both
+# results must be WANT;
+check_threads() {
+  name=$1
+  total=$((total + 1))
+
+  "$MEWA" --threads=1 "$3" >"$tmp/want" 2>"$tmp/err"
+  "$MEWA" --threads=4 "$3" >"$tmp/out" 2>>"$tmp/err"
+
+  serial=$(sed 's/\x1b\[[0-9;]*m//g; s/ +\/- .*//' "$tmp/want" | sed -n 's/^= //p')
+  parallel=$(sed 's/\x1b\[[0-9;]*m//g; s/ +\/- .*//' "$tmp/out" | sed -n 's/^= //p')
+
+  if [ "$serial" != "$2" ] || [ "$parallel" != "$2" ]; then
+    echo "FAIL $name: got '$serial' serially and '$parallel' on threads, want '$2'"
+    sed 's/^/  /' "$tmp/err"
+    failed=$((failed + 1))
+    return
+  fi
+
+  echo "ok   $name"
+}
+
+check_threads "threads/let" 500000500000 't = 0; sum(k, 1, 1e6, (t = t + 1; t))'
+check_threads "threads/let/after" 1000000 't = 0; sum(k, 1, 1e6, (t = t + 1; 0)) + t'
+check_threads "threads/let/function" 500000500000 \
+  'f(x) = (u = x; u); sum(k, 1, 1e6, f(k)) + u - 1e6'
+check_threads "threads/pure" 500000500000 'sum(k, 1, 1e6, k)'
+
+if [ "$(uname)" = Linux ]; then
+  check_serve "serve/sum" -c 4 -n 20000 -p 8 -e '1 + 2*3' -w '= 7'
+  check_serve "serve/cmx" -n 100 -e '1 + 2i*3' -w '= 1 6i'
+  check_serve "serve/error" -n 100 -e '1 / 0' -w '! ERR_IR_DIV_BY_ZERO'
+  check_serve "serve/simplify" -n 100 -e '1*2*3' -w '= 6'
+fi
+
+echo "$((total - failed))/$total passed"
+[ $failed -eq 0 ]
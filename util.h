@@ -95,7 +95,7 @@
 
 #if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
 #include <memory.h>
-ssize_t getline(char **restrict lineptr, size_t *restrict n,
+static inline ssize_t getline(char **restrict lineptr, size_t *restrict n,
                 FILE *restrict stream) {
   if (*lineptr == NULL) {
     *n = 512;
@@ -127,6 +127,7 @@ ssize_t getline(char **restrict lineptr, size_t *restrict n,
 #endif
 
 #define MAX(a, b) (a >= b ? a : b)
+#define MIN(a, b) (a <= b ? a : b)
 
 #define ABS(a) (a >= 0 ? a : -a)
 
@@ -146,55 +147,6 @@ typedef uint64_t sym_t;
 
 typedef bool bol_t;
 
-#define SYM_T_BITSIZE (sizeof(sym_t) * 8)
-
-#define ENC_OFF ('Z' - 'A' + 1)
-
-//=:util:encoding
-
-char encode_symbol_c(char c) {
-  if (isupper(c))
-    return (c - 'A') + 1;
-  if (islower(c))
-    return (c - 'a') + ENC_OFF + 1;
-  if (c == '_')
-    return ENC_OFF * 2 + 1;
-  if (isdigit(c))
-    return (c - '0') + ENC_OFF * 2 + 2;
-
-  DBG_FATAL("symbol's character (%d) is out of range", c);
-  return 0;
-}
-
-char decode_symbol_c(char c) {
-  if (c >= 1 && c <= ENC_OFF)
-    return (c + 'A') - 1;
-  if (c >= ENC_OFF + 1 && c <= ENC_OFF * 2)
-    return (c + 'a') - ENC_OFF - 1;
-  if (c == ENC_OFF * 2 + 1)
-    return '_';
-  if (c >= ENC_OFF * 2 + 2 && c <= ENC_OFF * 2 + 12)
-    return (c + '0') - ENC_OFF * 2 - 2;
-
-  DBG_FATAL("symbol's character (%d) is out of range", c);
-  return 0;
-}
-
-char *decode_symbol(char *dst, char *dst_end, sym_t src) {
-  char *p, c;
-
-  for (p = dst; src && p < dst_end; ++p) {
-    c = src & ((1 << 6) - 1);
-    *p = decode_symbol_c(c);
-    src >>= 6;
-  }
-
-  if (src != 0)
-    FATAL("buffer capacity is not enough\n");
-
-  return p;
-}
-
 //=:lexer:tokens
 
 typedef enum {
@@ -224,6 +176,7 @@ typedef enum {
   TT_POW,
 
   TT_XPC,
+  TT_SEP,
   TT_SPZ,
 
   TT_NEG,
@@ -260,6 +213,7 @@ static inline const char *tt_stringify(Token_Type tt) {
     STRINGIFY_CASE(TT_MOD)
     STRINGIFY_CASE(TT_POW)
     STRINGIFY_CASE(TT_XPC)
+    STRINGIFY_CASE(TT_SEP)
     STRINGIFY_CASE(TT_SPZ)
     STRINGIFY_CASE(TT_NEG)
     STRINGIFY_CASE(TT_NOP)
@@ -300,6 +254,7 @@ typedef enum {
   NT_BIOP_POW,
 
   NT_BIOP_XPC,
+  NT_BIOP_SEP,
   NT_BIOP_SPZ,
 
   NT_BIOP_FAC,
@@ -311,8 +266,18 @@ typedef enum {
   NT_UNOP_NEG,
 
   NT_CALL,
+  NT_REDUCE,
+
+  NT_SAVE,
+  NT_POWI,
+  NT_POLY,
+  NT_ELSE,
+  NT_DEFINE,
+  NT_APPLY,
 } Node_Type;
 
+#define NT_COUNT (NT_APPLY + 1)
+
 //=:parser:nodes:stringify
 
 static inline const char *nt_stringify(Node_Type nt) {
@@ -335,6 +300,7 @@ static inline const char *nt_stringify(Node_Type nt) {
     STRINGIFY_CASE(NT_BIOP_MOD)
     STRINGIFY_CASE(NT_BIOP_POW)
     STRINGIFY_CASE(NT_BIOP_XPC)
+    STRINGIFY_CASE(NT_BIOP_SEP)
     STRINGIFY_CASE(NT_BIOP_SPZ)
     STRINGIFY_CASE(NT_BIOP_FAC)
     STRINGIFY_CASE(NT_UNOP_ABS)
@@ -342,6 +308,13 @@ static inline const char *nt_stringify(Node_Type nt) {
     STRINGIFY_CASE(NT_UNOP_NOP)
     STRINGIFY_CASE(NT_UNOP_NEG)
     STRINGIFY_CASE(NT_CALL)
+    STRINGIFY_CASE(NT_REDUCE)
+    STRINGIFY_CASE(NT_SAVE)
+    STRINGIFY_CASE(NT_POWI)
+    STRINGIFY_CASE(NT_POLY)
+    STRINGIFY_CASE(NT_ELSE)
+    STRINGIFY_CASE(NT_DEFINE)
+    STRINGIFY_CASE(NT_APPLY)
   }
 
   return STRINGIFY(INVALID_NT);
@@ -349,7 +322,7 @@ static inline const char *nt_stringify(Node_Type nt) {
 
 //=:parser:tokens:map
 
-Node_Type tt_to_biop_nd(Token_Type tt) {
+static inline Node_Type tt_to_biop_nd(Token_Type tt) {
   switch (tt) {
   case TT_LET: return NT_BIOP_LET;
   case TT_GRE: return NT_BIOP_GRE;
@@ -368,6 +341,7 @@ Node_Type tt_to_biop_nd(Token_Type tt) {
   case TT_MOD: return NT_BIOP_MOD;
   case TT_POW: return NT_BIOP_POW;
   case TT_XPC: return NT_BIOP_XPC;
+  case TT_SEP: return NT_BIOP_SEP;
   case TT_SPZ: return NT_BIOP_SPZ;
   case TT_FAC: return NT_BIOP_FAC;
   case TT_LP0: return NT_CALL;
@@ -376,7 +350,7 @@ Node_Type tt_to_biop_nd(Token_Type tt) {
   }
 }
 
-bool is_unop(Node_Type nt) {
+static inline bool is_unop(Node_Type nt) {
   return nt == NT_UNOP_NOT ||
          nt == NT_UNOP_NEG ||
          nt == NT_UNOP_ABS ||
@@ -385,9 +359,16 @@ bool is_unop(Node_Type nt) {
 
 //=:runtime
 
+// Slot - index of a variable in values of a program, given by resolution of
+// its symbols;
+typedef uint32_t Slot;
+
 typedef union {
   cmx_t c;
-  sym_t s;
+  struct {
+    sym_t s;
+    Slot slot;
+  };
 } Primitive;
 
 //=:runtime:assertions
@@ -406,7 +387,7 @@ typedef union {
 
 //=:runtime:operators
 
-double contains_interval(double a, double a_re, double b, double b_re) {
+static inline double contains_interval(double a, double a_re, double b, double b_re) {
   double al = (1 - a_re) * a, ah = (1 + a_re) * a;
   double bl = (1 - b_re) * b, bh = (1 + b_re) * b;
 
@@ -427,7 +408,7 @@ double contains_interval(double a, double a_re, double b, double b_re) {
   return intersection / bs;
 }
 
-cmx_t fac_cmx_helper(cmx_t i, uint64_t step) {
+static inline cmx_t fac_cmx_helper(cmx_t i, uint64_t step) {
   cmx_t rt = 0;
 
   for (uint64_t j = 1; j <= step; ++j)
@@ -436,7 +417,7 @@ cmx_t fac_cmx_helper(cmx_t i, uint64_t step) {
   return rt / step;
 }
 
-cmx_t fac_cmx(cmx_t base, cmx_t step) {
+static inline cmx_t fac_cmx(cmx_t base, cmx_t step) {
   ASSERT_IMG_ZER(base, "factorial");
 
   double rbase = creal(base);
@@ -458,7 +439,7 @@ enum {
   GAMMA_LOWER_QUO_E_ITER = 1 << 6,
 };
 
-cmx_t gamma_lower_quo_e(double s) {
+static inline cmx_t gamma_lower_quo_e(double s) {
   cmx_t rt = 0;
 
   for (int i = 0; i <= GAMMA_LOWER_QUO_E_ITER; ++i)
@@ -467,7 +448,7 @@ cmx_t gamma_lower_quo_e(double s) {
   return cpow((cmx_t)-1, (cmx_t)s) * rt;
 }
 
-cmx_t subfac_cmx(cmx_t base) {
+static inline cmx_t subfac_cmx(cmx_t base) {
   ASSERT_IMG_ZER(base, "subfactorial");
 
   double rbase = creal(base);